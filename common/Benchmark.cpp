@@ -0,0 +1,228 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+namespace {
+
+struct BenchmarkLog {
+    std::string variant = "unknown";
+    unsigned threads = 1;
+    std::vector<BenchmarkResult> results;
+};
+
+BenchmarkLog& benchmarkLog() {
+    static BenchmarkLog log;
+    return log;
+}
+
+std::string jsonEscape(const std::string& s) {
+    std::string out;
+    out.reserve(s.size() + 2);
+    for (char c : s) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+std::string csvQuote(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    return out + "\"";
+}
+
+// rows/s and GB/s at the median iteration time (0 if not reported)
+double rowsPerSecond(const BenchmarkResult& r) {
+    const double t = r.median();
+    return (t > 0 && r.scan.rows > 0) ? r.scan.rows / t : 0.0;
+}
+
+double gbPerSecond(const BenchmarkResult& r) {
+    const double t = r.median();
+    return (t > 0 && r.scan.bytes > 0) ? r.scan.bytes / t / 1e9 : 0.0;
+}
+
+// Counter value per scanned row (per run if the scan isn't reported)
+double perUnit(const BenchmarkResult& r, PerfCounters::Event e) {
+    const double runs = r.seconds.empty() ? 1.0 : static_cast<double>(r.seconds.size());
+    const double rows = r.scan.rows > 0 ? r.scan.rows : 1.0;
+    return static_cast<double>(r.perf.value[e]) / (runs * rows);
+}
+
+} // namespace
+
+double BenchmarkResult::total() const {
+    double sum = 0.0;
+    for (double s : seconds) sum += s;
+    return sum;
+}
+
+double BenchmarkResult::mean() const {
+    return seconds.empty() ? 0.0 : total() / static_cast<double>(seconds.size());
+}
+
+double BenchmarkResult::min() const {
+    return seconds.empty() ? 0.0 : *std::min_element(seconds.begin(), seconds.end());
+}
+
+double BenchmarkResult::percentile(double p) const {
+    if (seconds.empty()) return 0.0;
+    std::vector<double> sorted(seconds);
+    std::sort(sorted.begin(), sorted.end());
+    const double rank = std::ceil(p / 100.0 * static_cast<double>(sorted.size()));
+    const std::size_t i = rank < 1 ? 0 : static_cast<std::size_t>(rank) - 1;
+    return sorted[std::min(i, sorted.size() - 1)];
+}
+
+double BenchmarkResult::stddev() const {
+    if (seconds.size() < 2) return 0.0;
+    const double m = mean();
+    double sq = 0.0;
+    for (double s : seconds) sq += (s - m) * (s - m);
+    return std::sqrt(sq / static_cast<double>(seconds.size() - 1));
+}
+
+int benchmarkWarmupRuns() {
+    static const int runs = [] {
+        const char* env = std::getenv("NYC311_BENCH_WARMUP");
+        const int n = env ? std::atoi(env) : 1;
+        return n < 1 ? 1 : n;
+    }();
+    return runs;
+}
+
+void setBenchmarkContext(const std::string& variant, unsigned threads) {
+    benchmarkLog().variant = variant;
+    benchmarkLog().threads = threads;
+}
+
+void recordBenchmark(BenchmarkResult result) {
+    const BenchmarkResult& r = result;
+    std::cout << r.label
+              << " -> " << r.resultText
+              << ", total=" << r.total() << "s"
+              << ", avg=" << r.mean() << "s"
+              << ", min=" << r.min() << "s"
+              << ", med=" << r.median() << "s"
+              << ", p95=" << r.percentile(95) << "s"
+              << ", p99=" << r.percentile(99) << "s"
+              << ", sd=" << r.stddev() << "s";
+    if (rowsPerSecond(r) > 0) std::cout << ", " << rowsPerSecond(r) / 1e6 << " Mrows/s";
+    if (gbPerSecond(r) > 0)   std::cout << ", " << gbPerSecond(r) << " GB/s";
+    std::cout << "\n";
+
+    if (r.perf.any()) {
+        std::cout << "    perf:";
+        if (r.perf.ipc() > 0) std::cout << " IPC=" << r.perf.ipc() << ",";
+        std::cout << (r.scan.rows > 0 ? " per row:" : " per run:");
+        static const char* const kShort[PerfCounters::kEventCount] = {
+            "cycles", "instructions", "LLC-miss", "branch-miss", "dTLB-miss"
+        };
+        for (int e = 0; e < PerfCounters::kEventCount; ++e)
+            if (r.perf.valid[e])
+                std::cout << " " << kShort[e] << "=" << perUnit(r, static_cast<PerfCounters::Event>(e));
+        std::cout << "\n";
+    }
+
+    benchmarkLog().results.push_back(std::move(result));
+}
+
+const std::vector<BenchmarkResult>& benchmarkResults() {
+    return benchmarkLog().results;
+}
+
+void writeBenchmarkReports() {
+    const BenchmarkLog& log = benchmarkLog();
+
+    if (const char* path = std::getenv("NYC311_BENCH_JSON")) {
+        std::ofstream out(path);
+        if (!out) {
+            std::cerr << "Error: cannot write benchmark JSON to " << path << "\n";
+        } else {
+            out.precision(9);
+            out << "{\n  \"variant\": \"" << jsonEscape(log.variant) << "\",\n"
+                << "  \"threads\": " << log.threads << ",\n"
+                << "  \"benchmarks\": [";
+            for (std::size_t i = 0; i < log.results.size(); ++i) {
+                const BenchmarkResult& r = log.results[i];
+                out << (i ? ",\n" : "\n")
+                    << "    {\"label\": \"" << jsonEscape(r.label) << "\""
+                    << ", \"runs\": " << r.seconds.size()
+                    << ", \"warmup\": " << r.warmup
+                    << ", \"result\": " << r.result
+                    << ", \"rows\": " << r.scan.rows
+                    << ", \"bytes\": " << r.scan.bytes
+                    << ", \"min_s\": " << r.min()
+                    << ", \"median_s\": " << r.median()
+                    << ", \"p95_s\": " << r.percentile(95)
+                    << ", \"p99_s\": " << r.percentile(99)
+                    << ", \"mean_s\": " << r.mean()
+                    << ", \"stddev_s\": " << r.stddev()
+                    << ", \"rows_per_s\": " << rowsPerSecond(r)
+                    << ", \"gb_per_s\": " << gbPerSecond(r);
+                if (r.perf.any()) {
+                    out << ", \"ipc\": " << r.perf.ipc();
+                    for (int e = 0; e < PerfCounters::kEventCount; ++e) {
+                        const auto ev = static_cast<PerfCounters::Event>(e);
+                        if (r.perf.valid[e])
+                            out << ", \"" << PerfCounters::eventName(ev) << "_per_run\": "
+                                << perUnit(r, ev) * (r.scan.rows > 0 ? r.scan.rows : 1.0);
+                    }
+                }
+                out << ", \"samples_s\": [";
+                for (std::size_t s = 0; s < r.seconds.size(); ++s) out << (s ? ", " : "") << r.seconds[s];
+                out << "]}";
+            }
+            out << "\n  ]\n}\n";
+            std::cout << "[BENCH] wrote " << log.results.size() << " results to " << path << "\n";
+        }
+    }
+
+    if (const char* path = std::getenv("NYC311_BENCH_CSV")) {
+        std::ofstream out(path);
+        if (!out) {
+            std::cerr << "Error: cannot write benchmark CSV to " << path << "\n";
+        } else {
+            out.precision(9);
+            out << "variant,threads,label,runs,warmup,result,rows,bytes,min_s,median_s,p95_s,p99_s,mean_s,stddev_s,rows_per_s,gb_per_s,ipc";
+            for (int e = 0; e < PerfCounters::kEventCount; ++e)
+                out << ',' << PerfCounters::eventName(static_cast<PerfCounters::Event>(e)) << "_per_run";
+            out << '\n';
+            for (const BenchmarkResult& r : log.results) {
+                out << csvQuote(log.variant) << ',' << log.threads << ',' << csvQuote(r.label) << ','
+                    << r.seconds.size() << ',' << r.warmup << ',' << r.result << ','
+                    << r.scan.rows << ',' << r.scan.bytes << ','
+                    << r.min() << ',' << r.median() << ',' << r.percentile(95) << ',' << r.percentile(99) << ','
+                    << r.mean() << ',' << r.stddev() << ',' << rowsPerSecond(r) << ',' << gbPerSecond(r) << ',';
+                // Counter columns stay empty when not measured
+                if (r.perf.ipc() > 0) out << r.perf.ipc();
+                for (int e = 0; e < PerfCounters::kEventCount; ++e) {
+                    out << ',';
+                    const auto ev = static_cast<PerfCounters::Event>(e);
+                    if (r.perf.valid[e]) out << perUnit(r, ev) * (r.scan.rows > 0 ? r.scan.rows : 1.0);
+                }
+                out << '\n';
+            }
+            std::cout << "[BENCH] wrote " << log.results.size() << " results to " << path << "\n";
+        }
+    }
+}
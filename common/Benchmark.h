@@ -0,0 +1,199 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "PerfCounters.h"
+
+// ---------------------------------------------------------------------------
+// Benchmark
+//   One harness for all three programs, so their numbers compare directly:
+//
+//     benchmark("date range 2013", runs, [&]() { return query(); },
+//               sampleN, printItem, ScanVolume{rows, bytes});
+//
+//   Each call runs the query untimed first (checks the result, prints the
+//   sample), then NYC311_BENCH_WARMUP - 1 more untimed warm-up runs
+//   (default 1 in total), then times every one of the `runs` iterations on
+//   its own. The summary line reports total / avg plus min, median,
+//   p95, p99 and stddev of the iterations, and rows/s and GB/s when the
+//   call says how much it scans.
+//
+//   With NYC311_PERF=1 the timed runs are also wrapped in hardware counters
+//   (PerfCounters.h) and a second line gives IPC and misses per row.
+//
+//   Every result is also kept for machine-readable reports:
+//   NYC311_BENCH_JSON=path and/or NYC311_BENCH_CSV=path make
+//   writeBenchmarkReports() (called at the end of main) write them, tagged
+//   with the program variant and thread count, for tracking regressions
+//   across builds.
+// ---------------------------------------------------------------------------
+
+// What one run of a query reads: rows visited and bytes streamed (a cache
+// line per record for the AoS programs, only the touched columns for OoA).
+// Zero means "not reported".
+struct ScanVolume {
+    double rows = 0;
+    double bytes = 0;
+};
+
+struct BenchmarkResult {
+    std::string label;
+    int warmup = 0;
+    double result = 0;            // result size, or the scalar value
+    std::string resultText;       // "size=N" / "value=x" as printed
+    ScanVolume scan;
+    std::vector<double> seconds;  // one per timed run, in run order
+    PerfCounters::Sample perf;    // summed over all timed runs (if enabled)
+
+    double total() const;
+    double mean() const;
+    double min() const;
+    double median() const { return percentile(50); }
+    double percentile(double p) const;   // nearest rank
+    double stddev() const;
+};
+
+// Untimed runs per benchmark, including the result/sample run (>= 1)
+int benchmarkWarmupRuns();
+
+// Tags the reports: program name and worker threads
+void setBenchmarkContext(const std::string& variant, unsigned threads);
+
+// Prints the summary line and keeps the result for the reports
+void recordBenchmark(BenchmarkResult result);
+
+// Everything recorded so far, in order
+const std::vector<BenchmarkResult>& benchmarkResults();
+
+// Writes the JSON / CSV files named by the environment, if any
+void writeBenchmarkReports();
+
+// Detect if type has .size()
+template <typename T>
+class has_size {
+private:
+    template <typename U>
+    static auto test(int) -> decltype(std::declval<const U&>().size(), std::true_type{});
+    template <typename>
+    static std::false_type test(...);
+public:
+    static constexpr bool value = decltype(test<T>(0))::value;
+};
+
+// Detect if type supports operator[](size_t) (vector-like)
+template <typename T>
+class has_index {
+private:
+    template <typename U>
+    static auto test(int) -> decltype(std::declval<const U&>()[std::size_t{}], std::true_type{});
+    template <typename>
+    static std::false_type test(...);
+public:
+    static constexpr bool value = decltype(test<T>(0))::value;
+};
+
+// Prevent compiler from optimizing away benchmarked work
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__clang__) || defined(__GNUC__)
+    asm volatile("" : : "g"(value) : "memory");
+#else
+    volatile const T* p = &value;
+    (void)p;
+#endif
+}
+
+// Sample printer for vector-like containers (size + operator[])
+template <typename ResultT, typename PrintItemFn>
+typename std::enable_if<has_size<ResultT>::value && has_index<ResultT>::value>::type
+printSample(const ResultT& res, std::size_t sampleN, PrintItemFn printItem) {
+    if (sampleN == 0) return;
+    std::size_t n = res.size();
+    std::size_t k = (sampleN < n) ? sampleN : n;
+
+    std::cout << "  Results - (" << k << "/" << n << "):\n";
+    for (std::size_t i = 0; i < k; ++i) {
+        printItem(res[i], i);
+    }
+}
+
+// Sample printer for sized-but-not-indexable containers (e.g., map): no-op
+template <typename ResultT, typename PrintItemFn>
+typename std::enable_if<has_size<ResultT>::value && !has_index<ResultT>::value>::type
+printSample(const ResultT&, std::size_t, PrintItemFn) {}
+
+// Sample printer for scalars: no-op
+template <typename ResultT, typename PrintItemFn>
+typename std::enable_if<!has_size<ResultT>::value>::type
+printSample(const ResultT&, std::size_t, PrintItemFn) {}
+
+// Result as a number for the reports, and as text for the summary line
+// (scalars use std::cout's current formatting)
+template <typename ResultT>
+typename std::enable_if<has_size<ResultT>::value>::type
+describeResult(const ResultT& r, BenchmarkResult& out) {
+    out.result = static_cast<double>(r.size());
+    out.resultText = "size=" + std::to_string(r.size());
+}
+
+template <typename ResultT>
+typename std::enable_if<!has_size<ResultT>::value>::type
+describeResult(const ResultT& r, BenchmarkResult& out) {
+    std::ostringstream os;
+    os.copyfmt(std::cout);
+    os << "value=" << r;
+    out.result = static_cast<double>(r);
+    out.resultText = os.str();
+}
+
+// Generic benchmark with sampling
+template <typename Fn, typename PrintItemFn>
+auto benchmark(const std::string& label,
+               int runs,
+               Fn fn,
+               std::size_t sampleN,
+               PrintItemFn printItem,
+               ScanVolume scan = {}) -> decltype(fn()) {
+    using clock = std::chrono::steady_clock;
+
+    BenchmarkResult result;
+    result.label = label;
+    result.scan = scan;
+    result.warmup = benchmarkWarmupRuns();
+
+    // 1) Untimed run: correctness + sample printing, then further warm-ups
+    auto first = fn();
+    printSample(first, sampleN, printItem);
+    for (int i = 1; i < result.warmup; ++i) {
+        auto r = fn();
+        doNotOptimize(r);
+    }
+
+    // 2) Timed runs, each on its own; counters (if any) span all of them
+    result.seconds.reserve(runs > 0 ? static_cast<std::size_t>(runs) : 0);
+    PerfCounters perf;
+    perf.start();
+    for (int i = 0; i < runs; ++i) {
+        auto start = clock::now();
+        auto r = fn();
+        doNotOptimize(r);
+        result.seconds.push_back(std::chrono::duration<double>(clock::now() - start).count());
+    }
+    result.perf = perf.stop();
+
+    describeResult(first, result);
+    recordBenchmark(std::move(result));
+    return first;
+}
+
+// Overloads: no sample printing
+template <typename Fn>
+auto benchmark(const std::string& label, int runs, Fn fn, ScanVolume scan = {}) -> decltype(fn()) {
+    return benchmark(label, runs, fn, 0, [](const auto&, std::size_t) {}, scan);
+}
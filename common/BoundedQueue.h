@@ -0,0 +1,117 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+
+// ---------------------------------------------------------------------------
+// BoundedQueue
+//   Fixed-capacity multi-producer / multi-consumer FIFO for handing work
+//   between pipeline stages (the pipelined CSV ingest). Lock-free: each slot
+//   carries a sequence number, and producers / consumers claim positions
+//   with one CAS on the tail / head counter (Vyukov's bounded queue).
+//
+//   tryPush / tryPop never block. push / pop wait while the queue is full /
+//   empty (spin, then yield, then short sleeps), which is the backpressure
+//   between stages: a fast stage stalls instead of buffering without bound.
+//   close() ends the stream: pushes fail, and pop returns false once the
+//   queue is drained.
+//
+//   Capacity is rounded up to a power of two.
+// ---------------------------------------------------------------------------
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(std::size_t capacity) {
+        std::size_t cap = 2;
+        while (cap < capacity) cap *= 2;
+        mask_ = cap - 1;
+        slots_.reset(new Slot[cap]);
+        for (std::size_t i = 0; i < cap; ++i) slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    std::size_t capacity() const { return mask_ + 1; }
+
+    bool tryPush(T& value) {
+        std::size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& s = slots_[pos & mask_];
+            const std::size_t seq = s.seq.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    s.value = std::move(value);
+                    s.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;   // full
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPop(T& out) {
+        std::size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& s = slots_[pos & mask_];
+            const std::size_t seq = s.seq.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    out = std::move(s.value);
+                    s.seq.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;   // empty
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Waits for room; false if the queue was closed
+    bool push(T value) {
+        for (unsigned spin = 0; !closed_.load(std::memory_order_acquire); ++spin) {
+            if (tryPush(value)) return true;
+            backoff(spin);
+        }
+        return false;
+    }
+
+    // Waits for an item; false once the queue is closed and drained
+    bool pop(T& out) {
+        for (unsigned spin = 0;; ++spin) {
+            if (tryPop(out)) return true;
+            if (closed_.load(std::memory_order_acquire)) return tryPop(out);
+            backoff(spin);
+        }
+    }
+
+    void close() { closed_.store(true, std::memory_order_release); }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<std::size_t> seq{0};
+        T value{};
+    };
+
+    static void backoff(unsigned spin) {
+        if (spin < 64) return;
+        if (spin < 256) std::this_thread::yield();
+        else std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+
+    std::unique_ptr<Slot[]> slots_;
+    std::size_t mask_ = 0;
+    alignas(64) std::atomic<std::size_t> head_{0};
+    alignas(64) std::atomic<std::size_t> tail_{0};
+    alignas(64) std::atomic<bool> closed_{false};
+};
@@ -0,0 +1,52 @@
+#include "CpuFeatures.h"
+
+#include <cstdlib>
+#include <cstring>
+
+static CpuFeatures detect() {
+    CpuFeatures f;
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    f.sse42  = __builtin_cpu_supports("sse4.2");
+    f.avx2   = __builtin_cpu_supports("avx2");
+    f.avx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#endif
+    return f;
+}
+
+const CpuFeatures& cpuFeatures() {
+    static const CpuFeatures features = detect();
+    return features;
+}
+
+static SimdLevel detectLevel() {
+    const CpuFeatures& f = cpuFeatures();
+    SimdLevel level = f.avx512 ? SimdLevel::AVX512
+                    : f.avx2   ? SimdLevel::AVX2
+                    : f.sse42  ? SimdLevel::SSE42
+                               : SimdLevel::Scalar;
+
+    if (const char* cap = std::getenv("NYC311_SIMD")) {
+        SimdLevel limit = level;
+        if (std::strcmp(cap, "scalar") == 0)      limit = SimdLevel::Scalar;
+        else if (std::strcmp(cap, "sse42") == 0)  limit = SimdLevel::SSE42;
+        else if (std::strcmp(cap, "avx2") == 0)   limit = SimdLevel::AVX2;
+        else if (std::strcmp(cap, "avx512") == 0) limit = SimdLevel::AVX512;
+        if (limit < level) level = limit;
+    }
+    return level;
+}
+
+SimdLevel simdLevel() {
+    static const SimdLevel level = detectLevel();
+    return level;
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX512: return "avx512";
+        case SimdLevel::AVX2:   return "avx2";
+        case SimdLevel::SSE42:  return "sse4.2";
+        default:                return "scalar";
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+// ---------------------------------------------------------------------------
+// SimdLevel / CpuFeatures
+//   Runtime CPU feature detection for the hand-vectorized kernels.
+//   Kernels are compiled with per-function target attributes and picked at
+//   runtime, so one binary runs on any x86-64 (and non-x86 builds simply
+//   use the scalar code).
+//
+//   The environment variable NYC311_SIMD=scalar|sse42|avx2|avx512 caps the
+//   level, which is handy for A/B benchmarking the kernels.
+// ---------------------------------------------------------------------------
+enum class SimdLevel {
+    Scalar = 0,
+    SSE42  = 1,
+    AVX2   = 2,
+    AVX512 = 3   // AVX-512 F + BW
+};
+
+struct CpuFeatures {
+    bool sse42  = false;
+    bool avx2   = false;
+    bool avx512 = false;
+};
+
+// Detected once, cached.
+const CpuFeatures& cpuFeatures();
+
+// Highest usable level after applying the NYC311_SIMD cap.
+SimdLevel simdLevel();
+
+const char* simdLevelName(SimdLevel level);
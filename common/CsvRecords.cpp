@@ -0,0 +1,368 @@
+#include "CsvRecords.h"
+#include "CpuFeatures.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CSV_HAVE_X86_KERNELS 1
+#endif
+
+// ---------------------------------------------------------------------------
+// Block scanners
+// ---------------------------------------------------------------------------
+
+static void scanBlockScalar(const char* p, CsvBlockMasks& m) {
+    uint64_t quote = 0, comma = 0, cr = 0, lf = 0;
+    for (int i = 0; i < 64; ++i) {
+        const uint64_t bit = 1ull << i;
+        switch (p[i]) {
+            case '"':  quote |= bit; break;
+            case ',':  comma |= bit; break;
+            case '\r': cr    |= bit; break;
+            case '\n': lf    |= bit; break;
+            default: break;
+        }
+    }
+    m.quote = quote; m.comma = comma; m.cr = cr; m.lf = lf;
+}
+
+#ifdef CSV_HAVE_X86_KERNELS
+__attribute__((target("sse4.2")))
+static void scanBlockSse42(const char* p, CsvBlockMasks& m) {
+    const __m128i q = _mm_set1_epi8('"');
+    const __m128i c = _mm_set1_epi8(',');
+    const __m128i r = _mm_set1_epi8('\r');
+    const __m128i n = _mm_set1_epi8('\n');
+    uint64_t quote = 0, comma = 0, cr = 0, lf = 0;
+    for (int k = 0; k < 4; ++k) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * k));
+        const int shift = 16 * k;
+        quote |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, q)))) << shift;
+        comma |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, c)))) << shift;
+        cr    |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, r)))) << shift;
+        lf    |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, n)))) << shift;
+    }
+    m.quote = quote; m.comma = comma; m.cr = cr; m.lf = lf;
+}
+
+__attribute__((target("avx2")))
+static inline uint64_t maskEq64(__m256i lo, __m256i hi, __m256i needle) {
+    const uint32_t l = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, needle)));
+    const uint32_t h = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, needle)));
+    return static_cast<uint64_t>(l) | (static_cast<uint64_t>(h) << 32);
+}
+
+__attribute__((target("avx2")))
+static void scanBlockAvx2(const char* p, CsvBlockMasks& m) {
+    const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+    m.quote = maskEq64(lo, hi, _mm256_set1_epi8('"'));
+    m.comma = maskEq64(lo, hi, _mm256_set1_epi8(','));
+    m.cr    = maskEq64(lo, hi, _mm256_set1_epi8('\r'));
+    m.lf    = maskEq64(lo, hi, _mm256_set1_epi8('\n'));
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void scanBlockAvx512(const char* p, CsvBlockMasks& m) {
+    const __m512i v = _mm512_loadu_si512(p);
+    m.quote = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('"'));
+    m.comma = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(','));
+    m.cr    = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\r'));
+    m.lf    = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\n'));
+}
+#endif
+
+using BlockScanFn = void (*)(const char*, CsvBlockMasks&);
+
+static BlockScanFn selectScanner() {
+#ifdef CSV_HAVE_X86_KERNELS
+    switch (simdLevel()) {
+        case SimdLevel::AVX512: return scanBlockAvx512;
+        case SimdLevel::AVX2:   return scanBlockAvx2;
+        case SimdLevel::SSE42:  return scanBlockSse42;
+        default: break;
+    }
+#endif
+    return scanBlockScalar;
+}
+
+static BlockScanFn activeScanner() {
+    static const BlockScanFn fn = selectScanner();
+    return fn;
+}
+
+void scanCsvBlock(const char* p, CsvBlockMasks& m) {
+    activeScanner()(p, m);
+}
+
+const char* csvScannerName() {
+#ifdef CSV_HAVE_X86_KERNELS
+    return simdLevelName(simdLevel());
+#else
+    return simdLevelName(SimdLevel::Scalar);
+#endif
+}
+
+// Scans [p, p+n) for n <= 64; bytes past n read as zero (never structural).
+static inline void scanTail(BlockScanFn scan, const char* p, std::size_t n, CsvBlockMasks& m) {
+    if (n >= 64) {
+        scan(p, m);
+        return;
+    }
+    alignas(64) char buf[64] = {};
+    std::memcpy(buf, p, n);
+    scan(buf, m);
+}
+
+// Bit i of the result = XOR of bits 0..i (quote state after byte i).
+static inline uint64_t prefixXor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+static inline unsigned lowestBit(uint64_t x) {
+    return static_cast<unsigned>(__builtin_ctzll(x));
+}
+
+// ---------------------------------------------------------------------------
+// Record boundaries
+// ---------------------------------------------------------------------------
+
+const char* findRecordEnd(const char* p, const char* end) {
+    const BlockScanFn scan = activeScanner();
+    const std::size_t len = static_cast<std::size_t>(end - p);
+    uint64_t carry = 0;   // all ones when the block starts inside quotes
+
+    for (std::size_t base = 0; base < len; base += 64) {
+        CsvBlockMasks m;
+        scanTail(scan, p + base, len - base, m);
+        const uint64_t inside = prefixXor(m.quote) ^ carry;
+        const uint64_t ends = m.lf & ~inside;
+        if (ends) return p + base + lowestBit(ends);
+        carry = static_cast<uint64_t>(static_cast<int64_t>(inside) >> 63);
+    }
+    return end;
+}
+
+// One past the last unquoted '\n' in [p, end), or p if none
+const char* lastRecordEnd(const char* p, const char* end) {
+    const BlockScanFn scan = activeScanner();
+    const std::size_t len = static_cast<std::size_t>(end - p);
+    const char* last = p;
+    uint64_t carry = 0;
+
+    for (std::size_t base = 0; base < len; base += 64) {
+        CsvBlockMasks m;
+        scanTail(scan, p + base, len - base, m);
+        const uint64_t inside = prefixXor(m.quote) ^ carry;
+        const uint64_t ends = m.lf & ~inside;
+        if (ends) last = p + base + (63 - static_cast<unsigned>(__builtin_clzll(ends))) + 1;
+        carry = static_cast<uint64_t>(static_cast<int64_t>(inside) >> 63);
+    }
+    return last;
+}
+
+// Advances from `pos` (quote state `inQuotes`) to the first byte after an
+// unquoted '\n', i.e. the start of the next record.
+static std::size_t resyncToRecordStart(const char* data, std::size_t dataSize,
+                                       std::size_t pos, bool inQuotes) {
+    for (; pos < dataSize; ++pos) {
+        char c = data[pos];
+        if (c == '"') inQuotes = !inQuotes;
+        else if (c == '\n' && !inQuotes) return pos + 1;
+    }
+    return dataSize;
+}
+
+std::vector<std::size_t> splitRecordAligned(const char* data,
+                                            std::size_t dataSize,
+                                            std::size_t begin,
+                                            std::size_t end,
+                                            std::size_t parts) {
+    end = std::min(end, dataSize);
+    if (parts == 0) parts = 1;
+    if (begin >= end) return std::vector<std::size_t>(parts + 1, begin);
+
+    const std::size_t span = end - begin;
+    std::vector<std::size_t> nominal(parts + 1);
+    for (std::size_t i = 0; i <= parts; ++i)
+        nominal[i] = begin + span * i / parts;
+
+    // Pass 1: quote count of every nominal range (parallel, bandwidth bound)
+    std::vector<unsigned char> oddQuotes(parts, 0);
+    const long long P = static_cast<long long>(parts);
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (long long i = 0; i < P; ++i) {
+        const char* p = data + nominal[static_cast<std::size_t>(i)];
+        const char* e = data + nominal[static_cast<std::size_t>(i) + 1];
+        std::size_t quotes = static_cast<std::size_t>(std::count(p, e, '"'));
+        oddQuotes[static_cast<std::size_t>(i)] = static_cast<unsigned char>(quotes & 1);
+    }
+
+    // Prefix XOR gives the quote state at each nominal split point
+    std::vector<unsigned char> inQuotesAt(parts + 1, 0);
+    for (std::size_t i = 0; i < parts; ++i)
+        inQuotesAt[i + 1] = inQuotesAt[i] ^ oddQuotes[i];
+
+    // Pass 2: move each interior split (and the end) forward to a record start
+    std::vector<std::size_t> bounds(parts + 1);
+    bounds[0] = begin;
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (long long i = 1; i <= P; ++i) {
+        const std::size_t k = static_cast<std::size_t>(i);
+        // A split exactly after an unquoted '\n' is already a record start
+        if (nominal[k] == begin ||
+            (!inQuotesAt[k] && data[nominal[k] - 1] == '\n')) bounds[k] = nominal[k];
+        else bounds[k] = resyncToRecordStart(data, dataSize, nominal[k], inQuotesAt[k]);
+    }
+
+    // A long record can swallow several splits; keep the list monotonic
+    for (std::size_t i = 1; i <= parts; ++i)
+        bounds[i] = std::max(bounds[i], bounds[i - 1]);
+    return bounds;
+}
+
+// ---------------------------------------------------------------------------
+// Field tokenizer
+// ---------------------------------------------------------------------------
+
+// Slow path for one field [i, len): runs the quote state machine and writes
+// the unescaped value to `scratch`.
+static void unescapeField(const char* rec, std::size_t len, std::size_t i,
+                          std::string& scratch) {
+    bool inQuotes = false;
+    for (; i < len; ++i) {
+        char c = rec[i];
+        if (inQuotes) {
+            if (c == '"') {
+                if (i + 1 < len && rec[i + 1] == '"') {
+                    scratch += '"';
+                    ++i;
+                } else {
+                    inQuotes = false;
+                }
+            } else {
+                scratch += c;
+            }
+        } else {
+            if (c == '"') inQuotes = true;
+            else if (c != '\r') scratch += c;
+        }
+    }
+}
+
+namespace {
+
+// Collects fields of one record. Fields that need unescaping are written to
+// scratch and patched into views at the end, since scratch may reallocate.
+struct FieldSink {
+    const char* rec;
+    std::vector<std::string_view>& fields;
+    std::string& scratch;
+    std::vector<std::pair<std::size_t, std::size_t>>& pending;   // (field, scratch offset)
+
+    void emit(std::size_t s, std::size_t e, bool dirty) {
+        if (!dirty) {
+            fields.emplace_back(rec + s, e - s);
+            return;
+        }
+        // "plain quoted" -> view of the inside
+        if (e - s >= 2 && rec[s] == '"' && rec[e - 1] == '"' &&
+            !std::memchr(rec + s + 1, '"', e - s - 2)) {
+            fields.emplace_back(rec + s + 1, e - s - 2);
+            return;
+        }
+        const std::size_t from = scratch.size();
+        unescapeField(rec, e, s, scratch);
+        pending.emplace_back(fields.size(), from);
+        fields.emplace_back(nullptr, scratch.size() - from);
+    }
+
+    void finish() {
+        for (const auto& p : pending)
+            fields[p.first] = std::string_view(scratch.data() + p.second, fields[p.first].size());
+    }
+};
+
+} // namespace
+
+// Tokenizes rec[0, len), stopping early at an unquoted '\n' when
+// stopAtNewline is set. Returns the offset of that '\n' (or len).
+static std::size_t tokenize(const char* rec, std::size_t len, bool stopAtNewline,
+                            std::vector<std::string_view>& fields,
+                            std::string& scratch) {
+    fields.clear();
+    scratch.clear();
+    thread_local std::vector<std::pair<std::size_t, std::size_t>> pending;
+    pending.clear();
+    FieldSink sink{rec, fields, scratch, pending};
+
+    const BlockScanFn scan = activeScanner();
+    uint64_t carry = 0;
+    std::size_t fieldStart = 0;
+    bool fieldDirty = false;
+    std::size_t stopAt = len;
+
+    for (std::size_t base = 0; base < len; base += 64) {
+        CsvBlockMasks m;
+        scanTail(scan, rec + base, len - base, m);
+
+        const uint64_t inside = prefixXor(m.quote) ^ carry;
+        carry = static_cast<uint64_t>(static_cast<int64_t>(inside) >> 63);
+
+        uint64_t seps  = m.comma & ~inside;
+        uint64_t dirty = m.quote | m.cr;   // bytes that need the slow path
+        uint64_t stop  = stopAtNewline ? (m.lf & ~inside) : 0;
+        stop &= (0 - stop);                // first record end only
+        if (stop) seps &= stop - 1;
+
+        while (seps) {
+            const unsigned b = lowestBit(seps);
+            seps &= seps - 1;
+            const uint64_t below = (1ull << b) - 1;
+            sink.emit(fieldStart, base + b, fieldDirty || (dirty & below));
+            dirty &= ~((2ull << b) - 1);   // drop everything up to this comma
+            fieldDirty = false;
+            fieldStart = base + b + 1;
+        }
+
+        if (stop) {
+            const unsigned b = lowestBit(stop);
+            fieldDirty = fieldDirty || (dirty & (stop - 1));
+            stopAt = base + b;
+            break;
+        }
+        fieldDirty = fieldDirty || dirty;
+    }
+
+    sink.emit(fieldStart, stopAt, fieldDirty);
+    sink.finish();
+    return stopAt;
+}
+
+std::size_t splitCSVFields(const char* rec, std::size_t len,
+                           std::vector<std::string_view>& fields,
+                           std::string& scratch) {
+    tokenize(rec, len, false, fields, scratch);
+    return fields.size();
+}
+
+const char* splitCSVRecord(const char* p, const char* end,
+                           std::vector<std::string_view>& fields,
+                           std::string& scratch) {
+    const std::size_t len = static_cast<std::size_t>(end - p);
+    const std::size_t stop = tokenize(p, len, true, fields, scratch);
+    return (stop < len) ? p + stop + 1 : end;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// CSV record boundaries
+//   Helpers for splitting a raw CSV byte buffer (e.g. a MappedFile) into
+//   whole records. A record ends at the first '\n' that is NOT inside a
+//   quoted field, so quoted fields may contain commas and newlines.
+//
+//   Quote state is derived from quote parity: every '"' toggles it, which
+//   also holds for escaped quotes ("") because they come in pairs.
+//
+//   All scanning runs on a structural-character scanner that classifies 64
+//   bytes at a time (quote / comma / CR / LF bitmasks) with AVX-512, AVX2 or
+//   SSE4.2 compares, chosen at runtime (see CpuFeatures.h), with a scalar
+//   fallback. Quote state across the block is a prefix-XOR of the quote mask,
+//   so commas and newlines inside quotes are masked out without branching.
+// ---------------------------------------------------------------------------
+
+// Structural characters of one 64-byte block; bit i describes byte i.
+struct CsvBlockMasks {
+    uint64_t quote = 0;
+    uint64_t comma = 0;
+    uint64_t cr    = 0;
+    uint64_t lf    = 0;
+};
+
+// Classifies the 64 bytes at p with the best kernel for this CPU.
+void scanCsvBlock(const char* p, CsvBlockMasks& m);
+
+// Name of the kernel scanCsvBlock dispatches to ("avx2", "scalar", ...).
+const char* csvScannerName();
+
+// Returns a pointer to the '\n' terminating the record that starts at p
+// (p must be outside quotes), or `end` if the buffer ends first.
+const char* findRecordEnd(const char* p, const char* end);
+
+// Start of the record after the last complete record in [p, end), i.e. one
+// past its terminating '\n' (p must be a record start); p itself if no
+// record in the buffer is complete. Splits a read buffer into whole records
+// plus a tail to carry into the next read.
+const char* lastRecordEnd(const char* p, const char* end);
+
+// Splits [begin, end) of `data` into up to `parts` ranges that each start
+// and stop on record boundaries. `begin` must be a record start. Returns
+// parts+1 offsets (non-decreasing); range i is [bounds[i], bounds[i+1]).
+// The final boundary is the first record start at or after `end`, so it
+// may lie past `end` (never past `dataSize`).
+//
+// Quote parity for every range is counted in parallel (OpenMP; serially in
+// builds without -fopenmp), so each split point is resynced correctly even
+// inside multi-line quoted fields.
+std::vector<std::size_t> splitRecordAligned(const char* data,
+                                            std::size_t dataSize,
+                                            std::size_t begin,
+                                            std::size_t end,
+                                            std::size_t parts);
+
+// Splits one record [rec, rec+len) into fields without copying.
+//   - Unquoted fields and plain quoted fields ("a,b") are views into `rec`.
+//   - Fields with escaped quotes ("") are unescaped into `scratch` and
+//     viewed from there.
+// A '\r' outside quotes is dropped (CRLF files). Both vectors are reused
+// across calls; views stay valid until the next call or until `rec` goes away.
+// Escaped-quote semantics match the original per-character parser: inside
+// quotes "" is a literal quote, any other quote toggles the quote state.
+// Returns the number of fields.
+std::size_t splitCSVFields(const char* rec, std::size_t len,
+                           std::vector<std::string_view>& fields,
+                           std::string& scratch);
+
+// Fused findRecordEnd + splitCSVFields: tokenizes the record starting at p
+// in a single pass and returns the start of the next record (or `end`).
+const char* splitCSVRecord(const char* p, const char* end,
+                           std::vector<std::string_view>& fields,
+                           std::string& scratch);
@@ -0,0 +1,176 @@
+#include "DateParse.h"
+
+// Value of an ASCII digit; > 9 (as unsigned) for anything else
+static inline unsigned dig(char c) {
+    return static_cast<unsigned>(static_cast<unsigned char>(c)) - '0';
+}
+
+static inline bool isDigit(char c) {
+    return dig(c) <= 9;
+}
+
+// True when every value is a digit; bitwise & keeps it a single branch
+template <typename... D>
+static inline bool allDigits(D... d) {
+    return ((d <= 9u) & ...);
+}
+
+static inline bool rangesOk(const CivilTime& t) {
+    return t.month >= 1 && t.month <= 12 &&
+           t.day   >= 1 && t.day   <= 31 &&
+           t.hour <= 23 && t.minute <= 59 && t.second <= 60;
+}
+
+// 12-h clock -> 24-h clock (same rule as the original to24h helpers)
+static inline bool apply12h(CivilTime& t, unsigned hour12, char meridiem) {
+    const bool pm = (meridiem == 'P' || meridiem == 'p');
+    const bool am = (meridiem == 'A' || meridiem == 'a');
+    if (!(pm || am) || hour12 > 12) return false;
+    if (!pm) t.hour = static_cast<uint8_t>(hour12 == 12 ? 0 : hour12);
+    else     t.hour = static_cast<uint8_t>(hour12 == 12 ? 12 : hour12 + 12);
+    return true;
+}
+
+// "MM/DD/YYYY HH:MM:SS AM" — exactly 22 bytes
+static bool parseUsFixed(const char* s, CivilTime& t) {
+    const unsigned d0 = dig(s[0]),  d1 = dig(s[1]);
+    const unsigned d3 = dig(s[3]),  d4 = dig(s[4]);
+    const unsigned d6 = dig(s[6]),  d7 = dig(s[7]),  d8 = dig(s[8]), d9 = dig(s[9]);
+    const unsigned h0 = dig(s[11]), h1 = dig(s[12]);
+    const unsigned m0 = dig(s[14]), m1 = dig(s[15]);
+    const unsigned s0 = dig(s[17]), s1 = dig(s[18]);
+
+    // One combined check instead of a branch per digit
+    if (!allDigits(d0, d1, d3, d4, d6, d7, d8, d9, h0, h1, m0, m1, s0, s1)) return false;
+
+    t.month  = static_cast<uint8_t>(d0 * 10 + d1);
+    t.day    = static_cast<uint8_t>(d3 * 10 + d4);
+    t.year   = static_cast<uint16_t>(d6 * 1000 + d7 * 100 + d8 * 10 + d9);
+    t.minute = static_cast<uint8_t>(m0 * 10 + m1);
+    t.second = static_cast<uint8_t>(s0 * 10 + s1);
+    return apply12h(t, h0 * 10 + h1, s[20]) && rangesOk(t);
+}
+
+// "YYYY-MM-DDTHH:MM:SS" prefix; anything after the seconds must be a
+// fractional part and/or 'Z'
+static bool parseIso(const char* s, std::size_t len, CivilTime& t) {
+    const unsigned y0 = dig(s[0]),  y1 = dig(s[1]),  y2 = dig(s[2]), y3 = dig(s[3]);
+    const unsigned o0 = dig(s[5]),  o1 = dig(s[6]);
+    const unsigned d0 = dig(s[8]),  d1 = dig(s[9]);
+    const unsigned h0 = dig(s[11]), h1 = dig(s[12]);
+    const unsigned m0 = dig(s[14]), m1 = dig(s[15]);
+    const unsigned s0 = dig(s[17]), s1 = dig(s[18]);
+
+    if (!allDigits(y0, y1, y2, y3, o0, o1, d0, d1, h0, h1, m0, m1, s0, s1)) return false;
+    if (s[13] != ':' || s[16] != ':') return false;
+
+    std::size_t i = 19;
+    if (i < len && s[i] == '.') {
+        ++i;
+        while (i < len && isDigit(s[i])) ++i;
+    }
+    if (i < len && (s[i] == 'Z' || s[i] == 'z')) ++i;
+    if (i != len) return false;
+
+    t.year   = static_cast<uint16_t>(y0 * 1000 + y1 * 100 + y2 * 10 + y3);
+    t.month  = static_cast<uint8_t>(o0 * 10 + o1);
+    t.day    = static_cast<uint8_t>(d0 * 10 + d1);
+    t.hour   = static_cast<uint8_t>(h0 * 10 + h1);
+    t.minute = static_cast<uint8_t>(m0 * 10 + m1);
+    t.second = static_cast<uint8_t>(s0 * 10 + s1);
+    return rangesOk(t);
+}
+
+// Slow path with the leniency of the old sscanf pattern: 1-4 digit fields,
+// any run of spaces between date, time and AM/PM.
+static bool readNumber(const char* s, std::size_t len, std::size_t& i, unsigned& v) {
+    std::size_t start = i;
+    v = 0;
+    while (i < len && isDigit(s[i]) && i - start < 4) v = v * 10 + dig(s[i++]);
+    return i > start;
+}
+
+static bool expect(const char* s, std::size_t len, std::size_t& i, char c) {
+    if (i < len && s[i] == c) { ++i; return true; }
+    return false;
+}
+
+static void skipSpaces(const char* s, std::size_t len, std::size_t& i) {
+    while (i < len && s[i] == ' ') ++i;
+}
+
+static bool parseUsLoose(const char* s, std::size_t len, CivilTime& t) {
+    std::size_t i = 0;
+    unsigned mm, dd, yyyy, hh, mi, ss;
+    skipSpaces(s, len, i);
+    if (!readNumber(s, len, i, mm) || !expect(s, len, i, '/')) return false;
+    if (!readNumber(s, len, i, dd) || !expect(s, len, i, '/')) return false;
+    if (!readNumber(s, len, i, yyyy)) return false;
+    skipSpaces(s, len, i);
+    if (!readNumber(s, len, i, hh) || !expect(s, len, i, ':')) return false;
+    if (!readNumber(s, len, i, mi) || !expect(s, len, i, ':')) return false;
+    if (!readNumber(s, len, i, ss)) return false;
+    skipSpaces(s, len, i);
+    if (i + 2 > len || (s[i + 1] != 'M' && s[i + 1] != 'm')) return false;
+
+    t.year   = static_cast<uint16_t>(yyyy);
+    t.month  = static_cast<uint8_t>(mm);
+    t.day    = static_cast<uint8_t>(dd);
+    t.minute = static_cast<uint8_t>(mi);
+    t.second = static_cast<uint8_t>(ss);
+    return mi <= 59 && ss <= 60 && apply12h(t, hh, s[i]) && rangesOk(t);
+}
+
+bool parseTimestamp(const char* s, std::size_t len, CivilTime& out) {
+    if (!s || len < 11) return false;
+
+    if (len == 22 && s[2] == '/' && s[5] == '/' && s[10] == ' ' &&
+        s[13] == ':' && s[16] == ':' && s[19] == ' ' && (s[21] == 'M' || s[21] == 'm'))
+        return parseUsFixed(s, out);
+
+    if (len >= 19 && s[4] == '-' && s[7] == '-' && (s[10] == 'T' || s[10] == ' '))
+        return parseIso(s, len, out);
+
+    return parseUsLoose(s, len, out);
+}
+
+// Days since 1970-01-01 in the proleptic Gregorian calendar (era-based, so
+// no loops or tables; valid for any year this dataset can contain).
+static int64_t daysFromCivil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);             // [0, 399]
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;    // [0, 365]
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;            // [0, 146096]
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+int64_t toEpochSeconds(const CivilTime& t) {
+    return daysFromCivil(t.year, t.month, t.day) * 86400 +
+           t.hour * 3600 + t.minute * 60 + t.second;
+}
+
+CivilTime fromEpochSeconds(int64_t seconds) {
+    int64_t days = seconds / 86400;
+    int64_t rem = seconds % 86400;
+    if (rem < 0) { rem += 86400; --days; }
+
+    // Inverse of daysFromCivil
+    const int64_t z = days + 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    const unsigned d = doy - (153 * mp + 2) / 5 + 1;
+    const unsigned m = mp < 10 ? mp + 3 : mp - 9;
+
+    CivilTime t;
+    t.year   = static_cast<uint16_t>(static_cast<int64_t>(yoe) + era * 400 + (m <= 2));
+    t.month  = static_cast<uint8_t>(m);
+    t.day    = static_cast<uint8_t>(d);
+    t.hour   = static_cast<uint8_t>(rem / 3600);
+    t.minute = static_cast<uint8_t>(rem / 60 % 60);
+    t.second = static_cast<uint8_t>(rem % 60);
+    return t;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// ---------------------------------------------------------------------------
+// CivilTime / parseTimestamp
+//   Hand-written replacement for sscanf("%u/%u/%u %u:%u:%u %2s") on NYC 311
+//   timestamps. Every row carries up to four dates, so this sits on the
+//   ingest hot path.
+//
+//   Accepted formats:
+//     "MM/DD/YYYY HH:MM:SS AM"    2010-2019 export (12-h clock)
+//     "YYYY-MM-DDTHH:MM:SS[.fff]" 2020+ export (ISO 8601, 24-h clock;
+//                                 ' ' instead of 'T', fractional seconds
+//                                 and a trailing 'Z' are also accepted)
+//
+//   Both fixed-width layouts are decoded branch-light: all digit positions
+//   are converted and validated together. Non-zero-padded MM/DD/YYYY input
+//   falls back to a slower field-by-field path.
+//
+//   No time-zone conversion is applied; values are NYC local civil time.
+// ---------------------------------------------------------------------------
+struct CivilTime {
+    uint16_t year   = 0;
+    uint8_t  month  = 0;   // 1-12
+    uint8_t  day    = 0;   // 1-31
+    uint8_t  hour   = 0;   // 0-23
+    uint8_t  minute = 0;   // 0-59
+    uint8_t  second = 0;   // 0-59
+};
+
+// Returns false for empty or malformed input (`out` is then unspecified).
+bool parseTimestamp(const char* s, std::size_t len, CivilTime& out);
+
+// ---------------------------------------------------------------------------
+// Epoch conversion
+//   Seconds since 1970-01-01 00:00:00, treating the civil time as if it
+//   were UTC (no time zone or DST shift). Ordering and differences are exact,
+//   which is all range filters and durations need.
+// ---------------------------------------------------------------------------
+int64_t toEpochSeconds(const CivilTime& t);
+CivilTime fromEpochSeconds(int64_t seconds);
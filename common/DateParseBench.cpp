@@ -0,0 +1,94 @@
+// Micro-benchmark: parseTimestamp vs the sscanf pattern it replaced.
+//
+// Build:  g++ -std=c++17 -O2 -o date_bench DateParseBench.cpp DateParse.cpp
+// Run:    ./date_bench [count]
+#include "DateParse.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// The original parser (DateTime::parse / parseDateKey)
+static bool parseWithSscanf(const std::string& s, CivilTime& t) {
+    unsigned mm = 0, dd = 0, yyyy = 0, hh = 0, mi = 0, ss = 0;
+    char ampm[3] = {};
+    int n = std::sscanf(s.c_str(), "%u/%u/%u %u:%u:%u %2s",
+                        &mm, &dd, &yyyy, &hh, &mi, &ss, ampm);
+    if (n < 7) return false;
+    const bool pm = (ampm[0] == 'P' || ampm[0] == 'p');
+    t.year   = static_cast<uint16_t>(yyyy);
+    t.month  = static_cast<uint8_t>(mm);
+    t.day    = static_cast<uint8_t>(dd);
+    t.hour   = static_cast<uint8_t>(!pm ? (hh == 12 ? 0 : hh) : (hh == 12 ? 12 : hh + 12));
+    t.minute = static_cast<uint8_t>(mi);
+    t.second = static_cast<uint8_t>(ss);
+    return true;
+}
+
+static uint64_t pack(const CivilTime& t) {
+    return (static_cast<uint64_t>(t.year)   << 40) |
+           (static_cast<uint64_t>(t.month)  << 32) |
+           (static_cast<uint64_t>(t.day)    << 24) |
+           (static_cast<uint64_t>(t.hour)   << 16) |
+           (static_cast<uint64_t>(t.minute) <<  8) |
+            static_cast<uint64_t>(t.second);
+}
+
+template <typename Fn>
+static double timeIt(const std::vector<std::string>& input, Fn fn, uint64_t& checksum) {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t sum = 0;
+    for (const auto& s : input) {
+        CivilTime t;
+        if (fn(s, t)) sum += pack(t);
+    }
+    auto end = std::chrono::steady_clock::now();
+    checksum = sum;
+    return std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    const std::size_t count = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 5000000;
+
+    std::mt19937 rng(311);
+    std::vector<std::string> us, iso;
+    us.reserve(count);
+    iso.reserve(count);
+    char buf[40];
+    for (std::size_t i = 0; i < count; ++i) {
+        unsigned y = 2010 + rng() % 14, mo = 1 + rng() % 12, d = 1 + rng() % 28;
+        unsigned h = rng() % 24, mi = rng() % 60, s = rng() % 60;
+        std::snprintf(buf, sizeof(buf), "%02u/%02u/%04u %02u:%02u:%02u %s",
+                      mo, d, y, (h % 12 == 0) ? 12 : h % 12, mi, s, h < 12 ? "AM" : "PM");
+        us.emplace_back(buf);
+        std::snprintf(buf, sizeof(buf), "%04u-%02u-%02uT%02u:%02u:%02u.000", y, mo, d, h, mi, s);
+        iso.emplace_back(buf);
+    }
+
+    auto fast = [](const std::string& s, CivilTime& t) { return parseTimestamp(s.data(), s.size(), t); };
+
+    // Warm-up, then measure
+    uint64_t sumSscanf = 0, sumFast = 0, sumIso = 0;
+    timeIt(us, fast, sumFast);
+    double tSscanf = timeIt(us, parseWithSscanf, sumSscanf);
+    double tFast   = timeIt(us, fast, sumFast);
+    double tIso    = timeIt(iso, fast, sumIso);
+
+    const double n = static_cast<double>(count);
+    std::cout << "timestamps: " << count << "\n"
+              << "  sscanf          : " << tSscanf / n * 1e9 << " ns/op\n"
+              << "  parseTimestamp  : " << tFast   / n * 1e9 << " ns/op (MM/DD/YYYY)\n"
+              << "  parseTimestamp  : " << tIso    / n * 1e9 << " ns/op (ISO 8601)\n"
+              << "  speedup         : " << tSscanf / tFast << "x\n";
+
+    if (sumSscanf != sumFast || sumFast != sumIso) {
+        std::cerr << "checksum mismatch: results differ between parsers\n";
+        return 1;
+    }
+    std::cout << "  results         : identical\n";
+    return 0;
+}
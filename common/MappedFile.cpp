@@ -0,0 +1,88 @@
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& o) noexcept
+    : data_(std::exchange(o.data_, nullptr)),
+      size_(std::exchange(o.size_, 0)),
+      open_(std::exchange(o.open_, false)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& o) noexcept {
+    if (this != &o) {
+        close();
+        data_ = std::exchange(o.data_, nullptr);
+        size_ = std::exchange(o.size_, 0);
+        open_ = std::exchange(o.open_, false);
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error opening file: " << path << " (" << std::strerror(errno) << ")\n";
+        return false;
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        std::cerr << "Error reading file size: " << path << " (" << std::strerror(errno) << ")\n";
+        ::close(fd);
+        return false;
+    }
+
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ == 0) {
+        // mmap of length 0 is an error; an empty file is simply an empty range
+        ::close(fd);
+        open_ = true;
+        return true;
+    }
+
+    void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);   // the mapping keeps its own reference to the file
+    if (p == MAP_FAILED) {
+        std::cerr << "Error mapping file: " << path << " (" << std::strerror(errno) << ")\n";
+        size_ = 0;
+        return false;
+    }
+
+    // Loaders walk the file front to back (per thread), so ask for aggressive read-ahead
+    ::madvise(p, size_, MADV_SEQUENTIAL);
+
+    data_ = static_cast<const char*>(p);
+    open_ = true;
+    return true;
+}
+
+const char* MappedFile::release(const char* begin, const char* end) {
+    if (!data_) return begin;
+    const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const std::size_t from = (static_cast<std::size_t>(std::max(begin, data_) - data_) + page - 1) / page * page;
+    const std::size_t to = static_cast<std::size_t>(std::min(end, data_ + size_) - data_) / page * page;
+    if (from >= to) return begin;
+    ::madvise(const_cast<char*>(data_) + from, to - from, MADV_DONTNEED);
+    return data_ + to;
+}
+
+void MappedFile::close() {
+    if (data_) ::munmap(const_cast<char*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+    open_ = false;
+}
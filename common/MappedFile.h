@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// ---------------------------------------------------------------------------
+// MappedFile
+//   Read-only, RAII memory mapping of a whole file (POSIX mmap).
+//   Lets the loaders tokenize straight out of the page cache instead of
+//   copying every line into a std::string first.
+//
+//   Move-only; the mapping is released by close() or the destructor.
+// ---------------------------------------------------------------------------
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& o) noexcept;
+    MappedFile& operator=(MappedFile&& o) noexcept;
+
+    // Maps the file read-only. Returns false (and prints the reason) on failure.
+    bool open(const std::string& path);
+    void close();
+
+    // Drops the whole pages inside [begin, end) from this process's resident
+    // set (they stay in the page cache and fault back in if touched again).
+    // For single-pass readers that should not accumulate the file in RSS.
+    // Returns the end of the dropped range (end rounded down to a page), where
+    // the next call should begin.
+    const char* release(const char* begin, const char* end);
+
+    const char* data() const noexcept { return data_; }
+    std::size_t size() const noexcept { return size_; }
+    bool isOpen() const noexcept { return open_; }
+
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+    bool        open_ = false;   // also true for an empty file (nothing mapped)
+};
@@ -0,0 +1,93 @@
+#include "MemStats.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+// Reads "Key:   123 kB" lines of a /proc file; calls fn(key, bytes)
+template <typename Fn>
+static bool readKbFields(const char* path, Fn&& fn) {
+    std::FILE* f = std::fopen(path, "r");
+    if (!f) return false;
+    char line[256];
+    while (std::fgets(line, sizeof(line), f)) {
+        const char* colon = std::strchr(line, ':');
+        if (!colon) continue;
+        unsigned long long kb = 0;
+        if (std::sscanf(colon + 1, " %llu kB", &kb) != 1) continue;
+        fn(std::string(line, static_cast<std::size_t>(colon - line)), static_cast<std::size_t>(kb) * 1024);
+    }
+    std::fclose(f);
+    return true;
+}
+#endif
+
+MemStats readMemStats() {
+    MemStats s;
+#if defined(__linux__)
+    bool haveSplit = false;
+    readKbFields("/proc/self/status", [&](const std::string& key, std::size_t bytes) {
+        if (key == "VmRSS") { s.rss = bytes; s.valid = true; }
+        else if (key == "VmHWM") s.peakRss = bytes;
+        else if (key == "RssAnon") { s.anon = bytes; haveSplit = true; }
+        else if (key == "RssFile") s.file = bytes;
+        else if (key == "RssShmem") s.shmem = bytes;
+        else if (key == "HugetlbPages") s.hugetlb = bytes;
+    });
+
+    // Older kernels: statm has resident and shared (file + shmem) pages
+    if (!s.valid || !haveSplit) {
+        if (std::FILE* f = std::fopen("/proc/self/statm", "r")) {
+            unsigned long long size = 0, resident = 0, shared = 0;
+            if (std::fscanf(f, "%llu %llu %llu", &size, &resident, &shared) == 3) {
+                const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+                s.rss = resident * page;
+                s.file = shared * page;
+                s.anon = s.rss > s.file ? s.rss - s.file : 0;
+                if (s.peakRss < s.rss) s.peakRss = s.rss;
+                s.valid = true;
+            }
+            std::fclose(f);
+        }
+    }
+
+    readKbFields("/proc/self/smaps_rollup", [&](const std::string& key, std::size_t bytes) {
+        if (key == "AnonHugePages") s.anonHuge = bytes;
+    });
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                  reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS) {
+        s.rss = static_cast<std::size_t>(info.resident_size);
+        s.peakRss = static_cast<std::size_t>(info.resident_size_max);
+        s.valid = true;
+    }
+#endif
+    return s;
+}
+
+double rssMemMB() {
+    return static_cast<double>(readMemStats().rss) / (1024.0 * 1024.0);
+}
+
+void printMemStats(const char* label, const MemStats& s) {
+    if (!s.valid) {
+        std::cout << label << ": (not available on this platform)\n";
+        return;
+    }
+    const double mb = 1024.0 * 1024.0;
+    std::cout << label << ": rss=" << s.rss / mb << " MB, peak=" << s.peakRss / mb << " MB";
+    // Breakdown only where the OS reports one (Linux)
+    if (s.anon || s.file || s.shmem)
+        std::cout << ", anon=" << s.anon / mb << " MB, file=" << s.file / mb << " MB, shmem=" << s.shmem / mb << " MB"
+                  << ", thp=" << s.anonHuge / mb << " MB, hugetlb=" << s.hugetlb / mb << " MB";
+    std::cout << "\n";
+}
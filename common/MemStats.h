@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// MemStats
+//   Process memory as the OS sees it, for the before/after-load reports.
+//
+//   Linux reads /proc/self/status (VmRSS, VmHWM, RssAnon/RssFile/RssShmem,
+//   HugetlbPages), falls back to /proc/self/statm on kernels without the
+//   split fields, and takes transparent huge pages from
+//   /proc/self/smaps_rollup when it exists. macOS fills rss / peakRss from
+//   mach task_info. Elsewhere `valid` stays false and everything is 0.
+// ---------------------------------------------------------------------------
+struct MemStats {
+    bool valid = false;
+    std::size_t rss = 0;        // resident set
+    std::size_t peakRss = 0;    // high-water mark of rss
+    std::size_t anon = 0;       // resident anonymous memory (heap, stacks)
+    std::size_t file = 0;       // resident file-backed pages (binary, mmap'd CSV)
+    std::size_t shmem = 0;      // resident shared memory
+    std::size_t anonHuge = 0;   // anonymous memory backed by transparent huge pages
+    std::size_t hugetlb = 0;    // explicit hugetlbfs pages
+};
+
+MemStats readMemStats();
+
+// Resident set in MB (0 if unavailable)
+double rssMemMB();
+
+// One line: "<label>: rss=... MB, peak=... MB, anon=..., file=..., ..."
+void printMemStats(const char* label, const MemStats& s);
+
+// Heap bytes behind containers, for per-column accounting. A string only
+// counts its own buffer when it isn't stored inline (short-string
+// optimization).
+inline std::size_t allocatedBytes(const std::string& s) {
+    const char* p = s.data();
+    const char* self = reinterpret_cast<const char*>(&s);
+    return (p >= self && p < self + sizeof(s)) ? 0 : s.capacity() + 1;
+}
+
+template <typename T>
+std::size_t allocatedBytes(const std::vector<T>& v) {
+    return v.capacity() * sizeof(T);
+}
+
+inline std::size_t allocatedBytes(const std::vector<std::string>& v) {
+    std::size_t bytes = v.capacity() * sizeof(std::string);
+    for (const auto& s : v) bytes += allocatedBytes(s);
+    return bytes;
+}
@@ -0,0 +1,170 @@
+#include "PerfCounters.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+bool PerfCounters::Sample::any() const {
+    for (int e = 0; e < kEventCount; ++e)
+        if (valid[e]) return true;
+    return false;
+}
+
+double PerfCounters::Sample::ipc() const {
+    if (!valid[Cycles] || !valid[Instructions] || value[Cycles] == 0) return 0.0;
+    return static_cast<double>(value[Instructions]) / static_cast<double>(value[Cycles]);
+}
+
+bool PerfCounters::requested() {
+    static const bool on = [] {
+        const char* env = std::getenv("NYC311_PERF");
+        return env && *env && std::strcmp(env, "0") != 0;
+    }();
+    return on;
+}
+
+const char* PerfCounters::eventName(Event e) {
+    switch (e) {
+        case Cycles:       return "cycles";
+        case Instructions: return "instructions";
+        case LlcMisses:    return "llc_misses";
+        case BranchMisses: return "branch_misses";
+        case DtlbMisses:   return "dtlb_misses";
+        default:           return "?";
+    }
+}
+
+#if defined(__linux__)
+
+static int openEvent(uint32_t type, uint64_t config, pid_t tid, int groupFd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = groupFd == -1 ? 1 : 0;   // the leader gates the group
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+                       PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, tid, -1, groupFd, 0));
+}
+
+static void eventConfig(PerfCounters::Event e, uint32_t& type, uint64_t& config) {
+    type = PERF_TYPE_HARDWARE;
+    switch (e) {
+        case PerfCounters::Cycles:       config = PERF_COUNT_HW_CPU_CYCLES; break;
+        case PerfCounters::Instructions: config = PERF_COUNT_HW_INSTRUCTIONS; break;
+        case PerfCounters::LlcMisses:    config = PERF_COUNT_HW_CACHE_MISSES; break;
+        case PerfCounters::BranchMisses: config = PERF_COUNT_HW_BRANCH_MISSES; break;
+        default:
+            type = PERF_TYPE_HW_CACHE;
+            config = PERF_COUNT_HW_CACHE_DTLB |
+                     (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+    }
+}
+
+PerfCounters::PerfCounters(bool enable) {
+    if (!enable) return;
+
+    std::vector<pid_t> tids;
+    if (DIR* dir = opendir("/proc/self/task")) {
+        while (dirent* d = readdir(dir))
+            if (d->d_name[0] != '.') tids.push_back(static_cast<pid_t>(std::atoi(d->d_name)));
+        closedir(dir);
+    }
+
+    int firstError = 0;
+    for (pid_t tid : tids) {
+        Group g;
+        for (int e = 0; e < kEventCount; ++e) { g.fds[e] = -1; g.ids[e] = 0; }
+        for (int e = 0; e < kEventCount; ++e) {
+            uint32_t type;
+            uint64_t config;
+            eventConfig(static_cast<Event>(e), type, config);
+            g.fds[e] = openEvent(type, config, tid, e == Cycles ? -1 : g.fds[Cycles]);
+            if (g.fds[e] < 0 && !firstError) firstError = errno;
+            if (g.fds[e] >= 0 && ioctl(g.fds[e], PERF_EVENT_IOC_ID, &g.ids[e]) != 0) {
+                close(g.fds[e]);
+                g.fds[e] = -1;
+            }
+            if (e == Cycles && g.fds[e] < 0) break;   // no leader, no group
+        }
+        if (g.fds[Cycles] >= 0) groups_.push_back(g);
+    }
+
+    static bool warned = false;
+    if (groups_.empty() && !warned) {
+        warned = true;
+        std::cerr << "[PERF] hardware counters unavailable (" << std::strerror(firstError ? firstError : ENOENT)
+                  << "); timing only. Check /proc/sys/kernel/perf_event_paranoid or run on bare metal.\n";
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (const Group& g : groups_)
+        for (int fd : g.fds)
+            if (fd >= 0) close(fd);
+}
+
+void PerfCounters::start() {
+    for (const Group& g : groups_) {
+        ioctl(g.fds[Cycles], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(g.fds[Cycles], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+PerfCounters::Sample PerfCounters::stop() {
+    Sample s;
+    for (const Group& g : groups_) ioctl(g.fds[Cycles], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    double sums[kEventCount] = {};
+    for (const Group& g : groups_) {
+        // Group read: nr, time_enabled, time_running, then {value, id} per event
+        uint64_t buf[3 + 2 * kEventCount];
+        const ssize_t got = read(g.fds[Cycles], buf, sizeof(buf));
+        if (got < static_cast<ssize_t>(3 * sizeof(uint64_t))) continue;
+        const uint64_t nr = buf[0], enabled = buf[1], running = buf[2];
+        if (running == 0) continue;   // never scheduled (PMU busy)
+        const double scale = static_cast<double>(enabled) / static_cast<double>(running);
+
+        for (uint64_t i = 0; i < nr && i < static_cast<uint64_t>(kEventCount); ++i) {
+            const uint64_t value = buf[3 + 2 * i], id = buf[4 + 2 * i];
+            for (int e = 0; e < kEventCount; ++e) {
+                if (g.fds[e] >= 0 && g.ids[e] == id) {
+                    sums[e] += static_cast<double>(value) * scale;
+                    s.valid[e] = true;
+                    break;
+                }
+            }
+        }
+    }
+    for (int e = 0; e < kEventCount; ++e) s.value[e] = static_cast<uint64_t>(sums[e]);
+    return s;
+}
+
+#else
+
+PerfCounters::PerfCounters(bool enable) {
+    static bool warned = false;
+    if (enable && !warned) {
+        warned = true;
+        std::cerr << "[PERF] hardware counters need Linux perf_event_open; timing only.\n";
+    }
+}
+PerfCounters::~PerfCounters() {}
+void PerfCounters::start() {}
+PerfCounters::Sample PerfCounters::stop() { return Sample{}; }
+
+#endif
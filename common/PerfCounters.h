@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// PerfCounters
+//   Hardware counters around a piece of work, via Linux perf_event_open:
+//   cycles, instructions, last-level-cache misses, branch misses and dTLB
+//   read misses. Off unless NYC311_PERF=1 is set; the benchmark harness then
+//   wraps every query's timed runs in one and reports IPC and misses per row.
+//
+//   Counters are opened for every thread of the process that exists at
+//   construction (the query pool's workers and OpenMP's), user space only,
+//   one group per thread with cycles as leader so ratios come from the same
+//   time slices. Counts are summed over threads and scaled if the kernel
+//   had to multiplex the group.
+//
+//   Anything that can't be counted (no PMU in a VM, perf_event_paranoid,
+//   non-Linux) is reported as unavailable, never as an error; an event the
+//   CPU lacks only drops that event.
+// ---------------------------------------------------------------------------
+class PerfCounters {
+public:
+    enum Event { Cycles, Instructions, LlcMisses, BranchMisses, DtlbMisses, kEventCount };
+
+    struct Sample {
+        bool valid[kEventCount] = {};
+        uint64_t value[kEventCount] = {};
+
+        bool any() const;
+        // instructions / cycles, or 0 if either is missing
+        double ipc() const;
+    };
+
+    // True if NYC311_PERF is set (to anything but "0")
+    static bool requested();
+    static const char* eventName(Event e);
+
+    // Opens the counters when `enable` is true; otherwise does nothing
+    explicit PerfCounters(bool enable = requested());
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const { return !groups_.empty(); }
+
+    void start();
+    Sample stop();
+
+private:
+    struct Group {
+        int fds[kEventCount];        // -1 if the event didn't open; fds[Cycles] leads
+        uint64_t ids[kEventCount];   // kernel ids, to match group read entries
+    };
+    std::vector<Group> groups_;
+};
@@ -0,0 +1,30 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// sortRowIds
+//   Puts distinct row ids of a `tableRows`-row table in ascending order, for
+//   indexes whose matches come out in index order (a sorted-key span, grid
+//   cells) but are returned in row order like a scan.
+//
+//   A result of k rows is sorted directly while k < tableRows / 64 (about
+//   219K rows of a 14M-row table). From there it goes through a bitmap over
+//   the table instead: setting k bits and reading back tableRows / 64 words
+//   is linear, and at that size the word pass costs no more than one pass
+//   over the rows, while the O(k log k) sort keeps growing.
+// ---------------------------------------------------------------------------
+inline void sortRowIds(std::vector<std::size_t>& rows, std::size_t tableRows) {
+    if (rows.size() * 64 < tableRows) {
+        std::sort(rows.begin(), rows.end());
+        return;
+    }
+    std::vector<uint64_t> words((tableRows + 63) / 64, 0);
+    for (std::size_t i : rows) words[i / 64] |= uint64_t(1) << (i % 64);
+    std::size_t n = 0;
+    for (std::size_t w = 0; w < words.size(); ++w)
+        for (uint64_t bits = words[w]; bits != 0; bits &= bits - 1)
+            rows[n++] = w * 64 + static_cast<std::size_t>(__builtin_ctzll(bits));
+}
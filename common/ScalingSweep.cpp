@@ -0,0 +1,57 @@
+#include "ScalingSweep.h"
+
+#include "ThreadPool.h"
+
+#include <iomanip>
+#include <iostream>
+
+std::vector<unsigned> sweepThreadCounts(unsigned maxThreads) {
+    std::vector<unsigned> counts;
+    for (unsigned p = 1; p < maxThreads; p *= 2) counts.push_back(p);
+    counts.push_back(maxThreads > 0 ? maxThreads : 1);
+    return counts;
+}
+
+void runThreadSweep(const std::vector<SweepQuery>& queries, int runs) {
+    ThreadPool& pool = ThreadPool::global();
+    const std::vector<unsigned> counts = sweepThreadCounts(pool.capacity());
+
+    // medians[q][i]: query q at counts[i] threads
+    std::vector<std::vector<double>> medians(queries.size(), std::vector<double>(counts.size(), 0.0));
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+        pool.setActiveWorkers(counts[i]);
+        std::cout << "\n[SWEEP] " << counts[i] << " of " << pool.capacity() << " workers\n";
+        for (std::size_t q = 0; q < queries.size(); ++q) {
+            queries[q].bench(queries[q].label + " @" + std::to_string(counts[i]) + "T", runs);
+            medians[q][i] = benchmarkResults().back().median();
+        }
+    }
+    pool.setActiveWorkers(pool.capacity());
+
+    std::ios saved(nullptr);
+    saved.copyfmt(std::cout);
+    std::cout << std::fixed;
+
+    std::cout << "\n=== Thread Scaling (median per run; speedup vs 1 thread) ===\n";
+    for (std::size_t q = 0; q < queries.size(); ++q) {
+        std::cout << "\n" << queries[q].label << "\n"
+                  << "    threads    median_s   speedup  efficiency  serial_frac\n";
+        const double t1 = medians[q][0];
+        for (std::size_t i = 0; i < counts.size(); ++i) {
+            const double p = counts[i];
+            const double tp = medians[q][i];
+            const double speedup = tp > 0 ? t1 / tp : 0.0;
+            std::cout << "    " << std::setw(7) << counts[i]
+                      << std::setprecision(6) << std::setw(12) << tp
+                      << std::setprecision(2) << std::setw(10) << speedup
+                      << std::setprecision(1) << std::setw(11) << 100.0 * speedup / p << "%";
+            // Karp-Flatt is undefined at p = 1
+            if (p > 1 && speedup > 0)
+                std::cout << std::setprecision(3) << std::setw(13) << (1.0 / speedup - 1.0 / p) / (1.0 - 1.0 / p);
+            else
+                std::cout << std::setw(13) << "-";
+            std::cout << "\n";
+        }
+    }
+    std::cout.copyfmt(saved);
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Benchmark.h"
+
+// ---------------------------------------------------------------------------
+// ScalingSweep
+//   Thread-scaling curves from one process: the data is loaded once, then
+//   every query is benchmarked with the shared pool limited to 1, 2, 4, ...
+//   workers up to its full size (ThreadPool::setActiveWorkers), instead of
+//   rerunning the program under different OMP_NUM_THREADS values.
+//
+//   Each point goes through benchmark(), labelled "<query> @<n>T", so it is
+//   printed and lands in the JSON / CSV reports like any other result. The
+//   closing table gives, per query and thread count p, the median time,
+//   speedup S = T1 / Tp, parallel efficiency S / p and the Karp-Flatt
+//   serial fraction (1/S - 1/p) / (1 - 1/p), whose growth with p points at
+//   overhead (merges, imbalance) rather than a fixed serial part.
+// ---------------------------------------------------------------------------
+
+struct SweepQuery {
+    std::string label;
+    // benchmark(pointLabel, runs, ...) over the query; records one result
+    std::function<void(const std::string& pointLabel, int runs)> bench;
+};
+
+template <typename Fn>
+SweepQuery sweepQuery(const std::string& label, Fn fn, ScanVolume scan = {}) {
+    return SweepQuery{label, [fn, scan](const std::string& pointLabel, int runs) {
+        benchmark(pointLabel, runs, fn, scan);
+    }};
+}
+
+// 1, 2, 4, ... below maxThreads, then maxThreads itself
+std::vector<unsigned> sweepThreadCounts(unsigned maxThreads);
+
+// Runs every query at every count on ThreadPool::global(), prints the
+// scaling table, and restores the pool to its full size
+void runThreadSweep(const std::vector<SweepQuery>& queries, int runs);
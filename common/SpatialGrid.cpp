@@ -0,0 +1,13 @@
+#include "SpatialGrid.h"
+
+SpatialGrid::SpatialGrid(const Box& extent, unsigned cellsPerSide)
+    : extent_(extent),
+      cells_(cellsPerSide > 0 ? cellsPerSide : 1),
+      latScale_(cells_ / (extent.maxLat - extent.minLat)),
+      lonScale_(cells_ / (extent.maxLon - extent.minLon)),
+      offsets_(cellCount() + 1, 0) {}
+
+std::size_t SpatialGrid::memoryBytes() const {
+    return (offsets_.capacity() + cellRows_.capacity() + outside_.capacity()) * sizeof(uint32_t) +
+           outsideLat_.capacity() * sizeof(double);
+}
@@ -0,0 +1,159 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "RowOrder.h"
+
+// ---------------------------------------------------------------------------
+// SpatialGrid
+//   Uniform grid over a fixed lat/lon extent (NYC by default) with the rows
+//   of every cell stored CSR-style, cells in row-major order. A box query
+//   visits only the cells it overlaps: rows of cells strictly inside the box
+//   are taken as-is and only cells on the box border are tested exactly.
+//   Rows outside the extent (e.g. missing coordinates loaded as 0,0) sit in
+//   one extra list sorted by latitude, so a box only binary-searches it;
+//   rows with a NaN coordinate can never match and are not stored.
+//
+//   Coordinates are read through accessors (lat(i), lon(i)), so the same
+//   grid serves the AoS vectors and the OoA columns. Results match a linear
+//   scan with minLat <= lat <= maxLat && minLon <= lon <= maxLon, in
+//   ascending row order.
+// ---------------------------------------------------------------------------
+class SpatialGrid {
+public:
+    struct Box {
+        double minLat, maxLat, minLon, maxLon;
+    };
+
+    // Five boroughs, with a little margin
+    static constexpr Box kNycExtent = {40.49, 40.92, -74.27, -73.68};
+
+    // A query declines (the caller scans instead) once its candidate rows
+    // exceed 1/kMaxCandidateShare of the table
+    static constexpr std::size_t kMaxCandidateShare = 16;
+
+    explicit SpatialGrid(const Box& extent = kNycExtent, unsigned cellsPerSide = 256);
+
+    // Indexes rows [0, n); row ids are stored as uint32_t
+    template <typename LatFn, typename LonFn>
+    void build(std::size_t n, LatFn lat, LonFn lon);
+
+    // Ascending rows inside `box` into `out`. Returns false, leaving `out`
+    // alone, if the box covers too much of the table for the index to beat
+    // a scan.
+    template <typename LatFn, typename LonFn>
+    bool query(const Box& box, LatFn lat, LonFn lon, std::vector<std::size_t>& out) const;
+
+    std::size_t rowCount() const { return rows_; }
+    std::size_t cellCount() const { return std::size_t(cells_) * cells_; }
+    std::size_t outsideCount() const { return outside_.size(); }
+    std::size_t memoryBytes() const;
+
+private:
+    // Cell index along one axis, clamped to [-1, cells_]; -1 and cells_ mean
+    // "off the grid". Monotonic in v, which is what makes "strictly between
+    // the box's border cells" an exact interior test. NaN maps to -1.
+    long cellOf(double v, double lo, double scale) const {
+        const double c = std::floor((v - lo) * scale);
+        if (!(c >= 0.0)) return -1;
+        return c >= cells_ ? static_cast<long>(cells_) : static_cast<long>(c);
+    }
+    long latCell(double v) const { return cellOf(v, extent_.minLat, latScale_); }
+    long lonCell(double v) const { return cellOf(v, extent_.minLon, lonScale_); }
+
+    // Rows in cells [c0, c1] of grid row r
+    std::size_t spanCount(long r, long c0, long c1) const {
+        return offsets_[r * cells_ + c1 + 1] - offsets_[r * cells_ + c0];
+    }
+
+    Box      extent_;
+    unsigned cells_;
+    double   latScale_, lonScale_;     // cells per degree
+
+    std::size_t           rows_ = 0;
+    std::vector<uint32_t> offsets_;    // cellCount() + 1
+    std::vector<uint32_t> cellRows_;   // rows of cell k: cellRows_[offsets_[k] .. offsets_[k + 1])
+    std::vector<uint32_t> outside_;    // rows off the grid, by latitude
+    std::vector<double>   outsideLat_; // their latitudes (ascending)
+};
+
+template <typename LatFn, typename LonFn>
+void SpatialGrid::build(std::size_t n, LatFn lat, LonFn lon) {
+    rows_ = n;
+    outside_.clear();
+    outsideLat_.clear();
+
+    // Counting sort by cell; rows stay ascending within every cell
+    std::vector<uint32_t> cellOfRow(n);
+    offsets_.assign(cellCount() + 1, 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        const double la = lat(i), lo = lon(i);
+        const long r = latCell(la), c = lonCell(lo);
+        if (r < 0 || c < 0 || r >= long(cells_) || c >= long(cells_)) {
+            cellOfRow[i] = UINT32_MAX;
+            if (!std::isnan(la) && !std::isnan(lo)) outside_.push_back(static_cast<uint32_t>(i));
+            continue;
+        }
+        cellOfRow[i] = static_cast<uint32_t>(r * cells_ + c);
+        offsets_[cellOfRow[i] + 1]++;
+    }
+    for (std::size_t k = 0; k < cellCount(); ++k) offsets_[k + 1] += offsets_[k];
+
+    cellRows_.assign(offsets_.back(), 0);
+    std::vector<uint32_t> pos(offsets_.begin(), offsets_.end() - 1);
+    for (std::size_t i = 0; i < n; ++i)
+        if (cellOfRow[i] != UINT32_MAX) cellRows_[pos[cellOfRow[i]]++] = static_cast<uint32_t>(i);
+
+    std::stable_sort(outside_.begin(), outside_.end(),
+                     [&](uint32_t a, uint32_t b) { return lat(a) < lat(b); });
+    outsideLat_.reserve(outside_.size());
+    for (uint32_t i : outside_) outsideLat_.push_back(lat(i));
+}
+
+template <typename LatFn, typename LonFn>
+bool SpatialGrid::query(const Box& box, LatFn lat, LonFn lon, std::vector<std::size_t>& out) const {
+    auto inside = [&](std::size_t i) {
+        const double la = lat(i), lo = lon(i);
+        return la >= box.minLat && la <= box.maxLat && lo >= box.minLon && lo <= box.maxLon;
+    };
+
+    // Border cells of the box (possibly off the grid) and the cells to visit
+    const long iMin = latCell(box.minLat), iMax = latCell(box.maxLat);
+    const long jMin = lonCell(box.minLon), jMax = lonCell(box.maxLon);
+    const long r0 = std::max(iMin, 0L), r1 = std::min(iMax, long(cells_) - 1);
+    const long c0 = std::max(jMin, 0L), c1 = std::min(jMax, long(cells_) - 1);
+
+    // Off-grid rows within the box's latitude range
+    const std::size_t o0 = std::lower_bound(outsideLat_.begin(), outsideLat_.end(), box.minLat) - outsideLat_.begin();
+    const std::size_t o1 = std::upper_bound(outsideLat_.begin(), outsideLat_.end(), box.maxLat) - outsideLat_.begin();
+
+    std::size_t candidates = o1 > o0 ? o1 - o0 : 0;
+    if (c0 <= c1)
+        for (long r = r0; r <= r1; ++r) candidates += spanCount(r, c0, c1);
+    if (candidates * kMaxCandidateShare > rows_) return false;
+
+    out.clear();
+    if (c0 <= c1) {
+        for (long r = r0; r <= r1; ++r) {
+            const bool borderRow = r == iMin || r == iMax;
+            for (long c = c0; c <= c1; ++c) {
+                const uint32_t* first = cellRows_.data() + offsets_[r * cells_ + c];
+                const uint32_t* last  = cellRows_.data() + offsets_[r * cells_ + c + 1];
+                if (borderRow || c == jMin || c == jMax) {
+                    for (const uint32_t* p = first; p != last; ++p)
+                        if (inside(*p)) out.push_back(*p);
+                } else {
+                    out.insert(out.end(), first, last);
+                }
+            }
+        }
+    }
+    for (std::size_t k = o0; k < o1; ++k)
+        if (inside(outside_[k])) out.push_back(outside_[k]);
+
+    sortRowIds(out, rows_);   // rows from several cells, back into row order
+    return true;
+}
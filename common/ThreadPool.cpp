@@ -0,0 +1,193 @@
+#include "ThreadPool.h"
+
+#include <cstdlib>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+static inline void cpuRelax() { _mm_pause(); }
+#else
+static inline void cpuRelax() { std::this_thread::yield(); }
+#endif
+
+// Spin this many rounds waiting for the next job (or for stragglers)
+// before blocking; back-to-back queries then skip the futex round trip.
+// An oversubscribed pool never spins: it would only steal the CPU from the
+// workers it is waiting for.
+static constexpr int kSpinRounds = 1 << 12;
+
+// Which pool (if any) the current thread is a worker of, and its index
+static thread_local const ThreadPool* tlsPool = nullptr;
+static thread_local unsigned tlsWorker = 0;
+
+static inline uint64_t packRange(std::size_t next, std::size_t end) {
+    return (static_cast<uint64_t>(next) << 32) | static_cast<uint32_t>(end);
+}
+static inline std::size_t rangeNext(uint64_t r) { return static_cast<std::size_t>(r >> 32); }
+static inline std::size_t rangeEnd(uint64_t r)  { return static_cast<std::size_t>(r & 0xffffffffu); }
+
+static unsigned envCount(const char* name) {
+    const char* v = std::getenv(name);
+    if (!v || !*v) return 0;
+    long n = std::strtol(v, nullptr, 10);
+    return n > 0 ? static_cast<unsigned>(n) : 0;
+}
+
+unsigned ThreadPool::defaultWorkerCount() {
+    if (unsigned n = envCount("NYC311_THREADS")) return n;
+    if (unsigned n = envCount("OMP_NUM_THREADS")) return n;
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw > 0 ? hw : 1;
+}
+
+ThreadPool& ThreadPool::global() {
+    static ThreadPool pool;
+    return pool;
+}
+
+ThreadPool::ThreadPool(unsigned workers)
+    : slots_(workers > 0 ? workers : defaultWorkerCount()) {
+    const unsigned hw = std::thread::hardware_concurrency();
+    spinRounds_ = (hw == 0 || slots_.size() <= hw) ? kSpinRounds : 0;
+    active_.store(static_cast<unsigned>(slots_.size()), std::memory_order_relaxed);
+    threads_.reserve(slots_.size() - 1);
+    for (unsigned w = 1; w < slots_.size(); ++w)
+        threads_.emplace_back(&ThreadPool::workerMain, this, w);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        stop_.store(true, std::memory_order_relaxed);
+        generation_.fetch_add(1, std::memory_order_release);
+    }
+    wake_.notify_all();
+    for (auto& t : threads_) t.join();
+}
+
+void ThreadPool::setActiveWorkers(unsigned n) {
+    std::lock_guard<std::mutex> runLock(runMutex_);
+    active_.store(std::max(1u, std::min(n, capacity())), std::memory_order_relaxed);
+}
+
+void ThreadPool::run(std::size_t n, std::size_t morsel, Invoke invoke, void* ctx) {
+    if (morsel == 0) morsel = kMorselRows;
+    const std::size_t M = morselCount(n, morsel);
+
+    // Nested job: run inline on the calling worker, in order
+    if (tlsPool == this) {
+        for (std::size_t m = 0; m < M; ++m)
+            invoke(ctx, Morsel{m, m * morsel, std::min(n, (m + 1) * morsel)}, tlsWorker);
+        return;
+    }
+
+    std::lock_guard<std::mutex> runLock(runMutex_);
+
+    tlsPool = this;
+    tlsWorker = 0;
+
+    const std::size_t W = size();
+
+    // Nothing to share: run inline as worker 0
+    if (W == 1 || M == 1) {
+        for (std::size_t m = 0; m < M; ++m)
+            invoke(ctx, Morsel{m, m * morsel, std::min(n, (m + 1) * morsel)}, 0);
+        tlsPool = nullptr;
+        return;
+    }
+
+    invoke_ = invoke;
+    ctx_ = ctx;
+    rows_ = n;
+    morsel_ = morsel;
+
+    // Morsel counts are packed in 32 bits; 2^32 morsels is far beyond any table here
+    for (std::size_t w = 0; w < W; ++w)
+        slots_[w].range.store(packRange(M * w / W, M * (w + 1) / W), std::memory_order_relaxed);
+
+    pending_.store(static_cast<unsigned>(W - 1), std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        generation_.fetch_add(1, std::memory_order_release);
+    }
+    wake_.notify_all();
+
+    work(0);
+    tlsPool = nullptr;
+
+    // Wait for the other workers to drain (their last morsels may still run)
+    for (int i = 0; i < spinRounds_ && pending_.load(std::memory_order_acquire) != 0; ++i) cpuRelax();
+    if (pending_.load(std::memory_order_acquire) != 0) {
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        done_.wait(lock, [&] { return pending_.load(std::memory_order_acquire) == 0; });
+    }
+}
+
+// Claims the next morsel of this worker's own run
+bool ThreadPool::popOwn(unsigned w, std::size_t& m) {
+    std::atomic<uint64_t>& range = slots_[w].range;
+    uint64_t r = range.load(std::memory_order_acquire);
+    while (rangeNext(r) < rangeEnd(r)) {
+        if (range.compare_exchange_weak(r, packRange(rangeNext(r) + 1, rangeEnd(r)),
+                                        std::memory_order_acq_rel, std::memory_order_acquire)) {
+            m = rangeNext(r);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Takes the back half of some other worker's run: the first morsel of the
+// stolen part is returned, the rest becomes this worker's own run
+bool ThreadPool::steal(unsigned w, std::size_t& m) {
+    const unsigned W = size();
+    for (unsigned k = 1; k < W; ++k) {
+        std::atomic<uint64_t>& victim = slots_[(w + k) % W].range;
+        uint64_t r = victim.load(std::memory_order_acquire);
+        while (rangeNext(r) < rangeEnd(r)) {
+            const std::size_t left = rangeEnd(r) - rangeNext(r);
+            const std::size_t cut = rangeEnd(r) - (left + 1) / 2;
+            if (victim.compare_exchange_weak(r, packRange(rangeNext(r), cut),
+                                             std::memory_order_acq_rel, std::memory_order_acquire)) {
+                m = cut;
+                slots_[w].range.store(packRange(cut + 1, rangeEnd(r)), std::memory_order_release);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void ThreadPool::work(unsigned w) {
+    std::size_t m;
+    while (popOwn(w, m) || steal(w, m))
+        invoke_(ctx_, Morsel{m, m * morsel_, std::min(rows_, (m + 1) * morsel_)}, w);
+}
+
+void ThreadPool::workerMain(unsigned w) {
+    tlsPool = this;
+    tlsWorker = w;
+    uint64_t seen = 0;
+    for (;;) {
+        // Spin briefly for the next job, then sleep
+        uint64_t g = generation_.load(std::memory_order_acquire);
+        for (int i = 0; i < spinRounds_ && g == seen; ++i) {
+            cpuRelax();
+            g = generation_.load(std::memory_order_acquire);
+        }
+        if (g == seen) {
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            wake_.wait(lock, [&] { return generation_.load(std::memory_order_acquire) != seen; });
+            g = generation_.load(std::memory_order_acquire);
+        }
+        seen = g;
+        if (stop_.load(std::memory_order_relaxed)) return;
+        if (w >= size()) continue;   // parked by setActiveWorkers()
+
+        work(w);
+
+        if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            done_.notify_one();
+        }
+    }
+}
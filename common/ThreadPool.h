@@ -0,0 +1,185 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// ThreadPool
+//   Long-lived, morsel-driven worker pool shared by all queries. It replaces
+//   a fresh `#pragma omp parallel` region (and fresh per-thread vectors) on
+//   every call.
+//
+//   forEachMorsel(n, body) cuts [0, n) into morsels (64K rows by default).
+//   Each worker starts with a contiguous run of morsels. When its run is
+//   empty it steals the back half of another worker's run, so skewed
+//   morsels (dense matches, expensive rows) balance themselves out.
+//   The calling thread works as worker 0; between jobs the other workers
+//   spin briefly and then sleep.
+//
+//   select(n, kernel) builds an ordered selection vector on top of
+//   forEachMorsel. Workers write into per-worker scratch buffers that the
+//   pool keeps across calls, then the pieces are stitched in morsel order.
+//
+//   Jobs from different threads are serialized. A job started from inside
+//   a pool worker runs inline on that worker.
+//
+//   setActiveWorkers(n) lets only the first n workers take part in later
+//   jobs (the rest stay parked), so one process can measure every thread
+//   count without rebuilding the pool. size() is that active count;
+//   capacity() is the number of threads the pool owns.
+// ---------------------------------------------------------------------------
+class ThreadPool {
+public:
+    static constexpr std::size_t kMorselRows = std::size_t(1) << 16;
+
+    struct Morsel {
+        std::size_t index;   // morsel number; ascending with begin
+        std::size_t begin;   // first row
+        std::size_t end;     // one past the last row
+    };
+
+    // `workers` includes the calling thread; 0 picks defaultWorkerCount()
+    explicit ThreadPool(unsigned workers = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Workers taking part in jobs; worker ids passed to bodies are < size()
+    unsigned size() const { return active_.load(std::memory_order_relaxed); }
+    // Threads owned (including the caller's slot); size per-worker state
+    // that outlives a job by this
+    unsigned capacity() const { return static_cast<unsigned>(slots_.size()); }
+
+    // Limits later jobs to the first n workers (clamped to [1, capacity()]);
+    // waits for a running job to finish
+    void setActiveWorkers(unsigned n);
+
+    // NYC311_THREADS, else OMP_NUM_THREADS, else hardware concurrency
+    static unsigned defaultWorkerCount();
+
+    // Process-wide pool, created on first use with defaultWorkerCount()
+    static ThreadPool& global();
+
+    static std::size_t morselCount(std::size_t n, std::size_t morsel = kMorselRows) {
+        return (n + morsel - 1) / morsel;
+    }
+
+    // Runs body(const Morsel&, unsigned worker) once for every morsel of
+    // [0, n); returns when all are done. Bodies run concurrently and in no
+    // particular order; `worker` < size() identifies the thread, e.g. for
+    // WorkerLocal scratch.
+    template <typename Body>
+    void forEachMorsel(std::size_t n, Body&& body, std::size_t morsel = kMorselRows) {
+        if (n == 0) return;
+        using B = std::remove_reference_t<Body>;
+        run(n, morsel, [](void* ctx, const Morsel& m, unsigned w) { (*static_cast<B*>(ctx))(m, w); },
+            const_cast<void*>(static_cast<const void*>(&body)));
+    }
+
+    // Ascending row ids selected by kernel(begin, end, out) -> count, where
+    // the kernel writes at most (end - begin) ids to `out`.
+    template <typename Kernel>
+    std::vector<std::size_t> select(std::size_t n, Kernel&& kernel);
+
+private:
+    using Invoke = void (*)(void*, const Morsel&, unsigned);
+
+    // Per-worker state, one cache line each: the worker's remaining morsel
+    // run packed as (next << 32 | end), plus its reusable select scratch.
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> range{0};
+        std::vector<std::size_t> scratch;
+        std::size_t scratchUsed = 0;
+    };
+
+    // Where one morsel's selected ids sit in the scratch buffers
+    struct Piece {
+        unsigned    worker;
+        std::size_t offset;
+        std::size_t count;
+        std::size_t outOffset;
+    };
+
+    void run(std::size_t n, std::size_t morsel, Invoke invoke, void* ctx);
+    void work(unsigned w);
+    bool popOwn(unsigned w, std::size_t& m);
+    bool steal(unsigned w, std::size_t& m);
+    void workerMain(unsigned w);
+
+    std::vector<Slot>        slots_;
+    std::vector<std::thread> threads_;
+
+    // Current job
+    Invoke      invoke_ = nullptr;
+    void*       ctx_ = nullptr;
+    std::size_t rows_ = 0;
+    std::size_t morsel_ = 0;
+
+    std::mutex              runMutex_;      // one job at a time
+    std::mutex              selectMutex_;   // one select() at a time (owns scratch)
+    std::mutex              wakeMutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::atomic<uint64_t>   generation_{0};
+    std::atomic<unsigned>   pending_{0};
+    std::atomic<bool>       stop_{false};
+    std::atomic<unsigned>   active_{0};     // changed only under runMutex_
+    int                     spinRounds_ = 0;
+};
+
+template <typename Kernel>
+std::vector<std::size_t> ThreadPool::select(std::size_t n, Kernel&& kernel) {
+    std::vector<std::size_t> out;
+    if (n == 0) return out;
+
+    std::lock_guard<std::mutex> lock(selectMutex_);
+    for (auto& s : slots_) s.scratchUsed = 0;
+
+    // Pass 1: each morsel appends its ids to its worker's scratch
+    std::vector<Piece> pieces(morselCount(n));
+    forEachMorsel(n, [&](const Morsel& m, unsigned w) {
+        Slot& s = slots_[w];
+        const std::size_t need = s.scratchUsed + (m.end - m.begin);
+        if (s.scratch.size() < need) s.scratch.resize(std::max(need, s.scratch.size() * 2));
+        const std::size_t count = kernel(m.begin, m.end, s.scratch.data() + s.scratchUsed);
+        pieces[m.index] = Piece{w, s.scratchUsed, count, 0};
+        s.scratchUsed += count;
+    });
+
+    // Prefix sum in morsel (= row) order, then copy the pieces in parallel
+    std::size_t total = 0;
+    for (auto& p : pieces) { p.outOffset = total; total += p.count; }
+    out.resize(total);
+    forEachMorsel(pieces.size(), [&](const Morsel& m, unsigned) {
+        for (std::size_t i = m.begin; i < m.end; ++i) {
+            const Piece& p = pieces[i];
+            const std::size_t* src = slots_[p.worker].scratch.data() + p.offset;
+            std::copy(src, src + p.count, out.data() + p.outOffset);
+        }
+    }, 1);
+    return out;
+}
+
+// One T per pool worker, each on its own cache line. For scratch that a
+// query keeps across calls (e.g. per-worker counters).
+template <typename T>
+class WorkerLocal {
+public:
+    explicit WorkerLocal(unsigned workers = ThreadPool::global().capacity()) : slots_(workers) {}
+
+    T& operator[](unsigned w) { return slots_[w].value; }
+    const T& operator[](unsigned w) const { return slots_[w].value; }
+    unsigned size() const { return static_cast<unsigned>(slots_.size()); }
+
+private:
+    struct alignas(64) Slot { T value{}; };
+    std::vector<Slot> slots_;
+};
@@ -6,7 +6,8 @@
 // ---------------------------------------------------------------------------
 // DateTime
 //   Represents a date/time value parsed from NYC 311 CSV timestamps.
-//   Format in the file: "MM/DD/YYYY HH:MM:SS AM" or empty string.
+//   Format in the file: "MM/DD/YYYY HH:MM:SS AM", ISO "YYYY-MM-DDTHH:MM:SS"
+//   (2020+ export) or empty string.
 //
 //   Fields are stored as the smallest suitable primitive types to minimise
 //   memory footprint across millions of records.
@@ -1,4 +1,11 @@
 #include "ServiceRequest.h"
+#include "../common/CsvRecords.h"
+#include "../common/SpatialGrid.h"
+#include "../common/MemStats.h"
+#include "../common/Benchmark.h"
+#include "../common/MappedFile.h"
+#include "../common/ThreadPool.h"
+#include "../common/ScalingSweep.h"
 #include <algorithm>
 #include <chrono>
 #include <cmath>
@@ -8,337 +15,277 @@
 #include <iostream>
 #include <map>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 #include <omp.h>
-#include <mach/mach.h>
 
 static std::vector<ServiceRequest> g_records;
+static SpatialGrid g_grid;   // lat/lon index over g_records, built after loading
 
-// Detect if type has .size()
-template <typename T>
-class has_size {
-private:
-    template <typename U>
-    static auto test(int) -> decltype(std::declval<const U&>().size(), std::true_type{});
-    template <typename>
-    static std::false_type test(...);
-
-public:
-    static constexpr bool value = decltype(test<T>(0))::value;
-};
-
-// Detect if type supports operator[](size_t) (vector-like)
-template <typename T>
-class has_index {
-private:
-    template <typename U>
-    static auto test(int) -> decltype(std::declval<const U&>()[std::size_t{}], std::true_type{});
-    template <typename>
-    static std::false_type test(...);
-
-public:
-    static constexpr bool value = decltype(test<T>(0))::value;
-};
-
-// Print summary for sized results
-template <typename ResultT>
-typename std::enable_if<has_size<ResultT>::value>::type
-printSummary(const std::string& label, int runs, double total, const ResultT& first) {
-    std::cout << label
-              << " -> size=" << first.size()
-              << ", total=" << total << "s"
-              << ", avg=" << (total / runs) << "s\n";
+std::string_view cleanString(std::string_view str) {
+    if (!str.empty() && str.front() == '"') str.remove_prefix(1);
+    if (!str.empty() && str.back()  == '"') str.remove_suffix(1);
+    return str;
 }
 
-// Print summary for scalar results
-template <typename ResultT>
-typename std::enable_if<!has_size<ResultT>::value>::type
-printSummary(const std::string& label, int runs, double total, const ResultT& first) {
-    std::cout << label
-              << " -> value=" << first
-              << ", total=" << total << "s"
-              << ", avg=" << (total / runs) << "s\n";
-}
-
-// Sample printer for vector-like containers (size + operator[])
-template <typename ResultT, typename PrintItemFn>
-typename std::enable_if<has_size<ResultT>::value && has_index<ResultT>::value>::type
-printSample(const ResultT& res, std::size_t sampleN, PrintItemFn printItem) {
-    if (sampleN == 0) return;
-    std::size_t n = res.size();
-    std::size_t k = (sampleN < n) ? sampleN : n;
-
-    std::cout << "  Results - (" << k << "/" << n << "):\n";
-    for (std::size_t i = 0; i < k; ++i) {
-        printItem(res[i], i);
+// Splits one CSV record [line, line+len) into `fields`, reusing the vector
+// (and each element's capacity) across calls to avoid per-line allocations.
+// Tokenizing runs on the SIMD structural scanner in common/CsvRecords.
+void parseCSVLine(const char* line, std::size_t len, std::vector<std::string>& fields) {
+    thread_local std::vector<std::string_view> views;
+    thread_local std::string scratch;
+
+    splitCSVFields(line, len, views, scratch);
+    fields.resize(views.size());
+    for (std::size_t i = 0; i < views.size(); ++i) {
+        std::string_view v = cleanString(views[i]);
+        fields[i].assign(v.data(), v.size());
     }
 }
 
-// Sample printer for sized-but-not-indexable containers (e.g., map): no-op by default
-template <typename ResultT, typename PrintItemFn>
-typename std::enable_if<has_size<ResultT>::value && !has_index<ResultT>::value>::type
-printSample(const ResultT&, std::size_t, PrintItemFn) {}
-
-// Sample printer for scalars: no-op
-template <typename ResultT, typename PrintItemFn>
-typename std::enable_if<!has_size<ResultT>::value>::type
-printSample(const ResultT&, std::size_t, PrintItemFn) {}
-
-// Prevent compiler from optimizing away benchmarked work
-template <typename T>
-inline void doNotOptimize(const T& value) {
-#if defined(__clang__) || defined(__GNUC__)
-    asm volatile("" : : "g"(value) : "memory");
-#else
-    volatile const T* p = &value;
-    (void)p;
-#endif
-}
-
-// Generic benchmark with sampling
-template <typename Fn, typename PrintItemFn>
-auto benchmark(const std::string& label,
-               int runs,
-               Fn fn,
-               std::size_t sampleN,
-               PrintItemFn printItem) -> decltype(fn()) {
-    using namespace std::chrono;
-
-    // 1) Untimed run: correctness + sample
-    auto first = fn();
-    printSample(first, sampleN, printItem);
-
-    // 2) Timed runs: no printing
-    auto start = high_resolution_clock::now();
-    for (int i = 0; i < runs; ++i) {
-        auto r = fn();
-        doNotOptimize(r);
-    }
-    auto end = high_resolution_clock::now();
-
-    double total = duration<double>(end - start).count();
-    printSummary(label, runs, total, first);
-
-    return first;
-}
-
-// Overload: no sample printing
-template <typename Fn>
-auto benchmark(const std::string& label, int runs, Fn fn) -> decltype(fn()) {
-    return benchmark(label, runs, fn, 0, [](const auto&, std::size_t) {});
-}
-
-std::string cleanString(const std::string& str) {
-    std::string cleaned = str;
-    if (!cleaned.empty() && cleaned.front() == '"') cleaned.erase(0, 1);
-    if (!cleaned.empty() && cleaned.back()  == '"') cleaned.pop_back();
-    return cleaned;
-}
-
 std::vector<std::string> parseCSVLine(const std::string& line) {
     std::vector<std::string> fields;
     fields.reserve(44);
-    std::string current;
-    current.reserve(64);
-    bool inQuotes = false;
-
-    for (std::size_t i = 0; i < line.size(); ++i) {
-        char c = line[i];
-        if (inQuotes) {
-            if (c == '"') {
-                // escaped quotes ("")
-                if (i + 1 < line.size() && line[i + 1] == '"') {
-                    current += '"';
-                    ++i;
-                } else {
-                    inQuotes = false;
-                }
-            } else {
-                current += c;
-            }
-        } else {
-            if (c == '"') {
-                inQuotes = true;
-            } else if (c == ',') {
-                fields.push_back(cleanString(current));
-                current.clear();
-            } else if (c == '\r') {
-                // skip
-            } else {
-                current += c;
-            }
-        }
-    }
-
-    fields.push_back(cleanString(current));
+    parseCSVLine(line.data(), line.size(), fields);
     return fields;
 }
 
-// RSS (macOS)
-static double rssMemMB() {
-    mach_task_basic_info_data_t info;
-    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
-    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
-                  reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS)
-        return 0.0;
-    return static_cast<double>(info.resident_size) / (1024.0 * 1024.0);
-}
-
-// NOTE: still single-threaded loader
+// Parallel loader: maps the file, splits it into record-aligned byte ranges
+// and parses the ranges on all OpenMP threads.
+//
+// The file is consumed in waves of PARTS_PER_THREAD * T ranges so the
+// MAX_RECORDS cap still bounds memory: after each wave the per-range
+// partitions are counted in file order and the load stops once the cap is hit.
+// A wave is also cut to the bytes the remaining records should take (bytes
+// per record from a sample of the file's start, then from the waves so far),
+// so the last one parses little beyond the cap.
+// Partitions are finally moved (not copied) into one contiguous vector.
 std::vector<ServiceRequest> loadDataParallel(const std::string& filename) {
     constexpr std::size_t MAX_RECORDS = 14000000;
+    constexpr std::size_t RANGE_BYTES = 32u << 20;   // ~32 MB of CSV per range
+    constexpr std::size_t PARTS_PER_THREAD = 4;      // slack for dynamic balancing
+    constexpr std::size_t SAMPLE_BYTES = 1u << 20;   // first bytes-per-record estimate
 
     auto start = std::chrono::high_resolution_clock::now();
-    std::cout << "[SINGLE-THREAD LOADER] Loading NYC 311 data from: " << filename << "\n";
+    const int T = omp_get_max_threads();
+    std::cout << "[PARALLEL LOADER] Loading NYC 311 data from: " << filename
+              << " (" << T << " threads)\n";
 
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error opening file: " << filename << "\n";
-        return {};
-    }
+    MappedFile file;
+    if (!file.open(filename)) return {};
 
-    std::vector<ServiceRequest> records;
-    std::string line;
-    std::size_t lineCount = 0;
-    std::size_t validRecords = 0;
+    const char* data = file.data();
+    const std::size_t size = file.size();
 
     // header
-    if (std::getline(file, line)) {
-        ++lineCount;
-        std::cout << "Skipped header: " << line.substr(0, 100) << "...\n";
+    std::size_t pos = 0;
+    if (size > 0) {
+        const char* headerEnd = findRecordEnd(data, data + size);
+        std::string header(data, static_cast<std::size_t>(headerEnd - data));
+        std::cout << "Skipped header: " << header.substr(0, 100) << "...\n";
+        pos = std::min(size, static_cast<std::size_t>(headerEnd - data) + 1);
+    }
+
+    const std::size_t dataStart = pos;
+    double bytesPerRecord = 0.0;
+    {
+        const char* cur = data + pos;
+        const char* end = data + std::min(size, pos + SAMPLE_BYTES);
+        std::size_t records = 0;
+        for (; cur < end; cur = findRecordEnd(cur, end) + 1) ++records;
+        if (records > 0) bytesPerRecord = static_cast<double>(cur - (data + pos)) / static_cast<double>(records);
     }
 
-    while (std::getline(file, line)) {
-        ++lineCount;
-        if (lineCount % 1000000 == 0) {
-            std::cout << "Processed " << lineCount
-                      << " lines, loaded " << validRecords << " records...\n";
+    std::vector<std::vector<ServiceRequest>> partitions;
+    std::size_t validRecords = 0;
+    const std::size_t partsPerWave = static_cast<std::size_t>(T) * PARTS_PER_THREAD;
+
+    while (pos < size && validRecords < MAX_RECORDS) {
+        // Near the cap, read only what the remaining records need (+1/8);
+        // if that falls short, the next wave picks up the rest
+        std::size_t waveBytes = partsPerWave * RANGE_BYTES;
+        if (bytesPerRecord > 0.0) {
+            const double need = static_cast<double>(MAX_RECORDS - validRecords) * bytesPerRecord * 1.125;
+            waveBytes = std::min(waveBytes, std::max(SAMPLE_BYTES, static_cast<std::size_t>(need)));
         }
+        const std::size_t waveEnd = std::min(size, pos + waveBytes);
+        std::vector<std::size_t> bounds = splitRecordAligned(data, size, pos, waveEnd, partsPerWave);
 
-        auto fields = parseCSVLine(line);
-        ServiceRequest req;
-        if (req.fromFields(fields)) {
-            records.push_back(std::move(req));
-            ++validRecords;
-            if (validRecords >= MAX_RECORDS) {
-                std::cout << "Reached limit of " << MAX_RECORDS << " records, stopping load.\n";
-                break;
+        std::vector<std::vector<ServiceRequest>> wave(partsPerWave);
+        const long long P = static_cast<long long>(partsPerWave);
+
+        #pragma omp parallel
+        {
+            std::vector<std::string> fields;
+            fields.reserve(44);
+
+            #pragma omp for schedule(dynamic, 1)
+            for (long long p = 0; p < P; ++p) {
+                const std::size_t k = static_cast<std::size_t>(p);
+                const char* cur = data + bounds[k];
+                const char* end = data + bounds[k + 1];
+                auto& out = wave[k];
+                out.reserve(static_cast<std::size_t>(end - cur) / 512 + 1);
+
+                while (cur < end) {
+                    const char* recEnd = findRecordEnd(cur, end);
+                    parseCSVLine(cur, static_cast<std::size_t>(recEnd - cur), fields);
+                    ServiceRequest req;
+                    if (req.fromFields(fields)) out.push_back(std::move(req));
+                    cur = recEnd + 1;
+                }
             }
         }
+
+        // Keep partitions in file order and enforce the record cap
+        for (auto& part : wave) {
+            if (validRecords >= MAX_RECORDS) break;
+            std::size_t room = MAX_RECORDS - validRecords;
+            if (part.size() > room) part.erase(part.begin() + static_cast<std::ptrdiff_t>(room), part.end());
+            validRecords += part.size();
+            partitions.push_back(std::move(part));
+        }
+
+        pos = bounds[partsPerWave];
+        if (validRecords > 0)
+            bytesPerRecord = static_cast<double>(pos - dataStart) / static_cast<double>(validRecords);
+        std::cout << "Processed " << (pos >> 20) << " / " << (size >> 20)
+                  << " MB, loaded " << validRecords << " records...\n";
+    }
+    if (validRecords >= MAX_RECORDS)
+        std::cout << "Reached limit of " << MAX_RECORDS << " records, stopping load.\n";
+
+    // Concatenate: move every partition into its slot in parallel, freeing
+    // each partition as soon as it is drained to cap peak memory
+    std::vector<std::size_t> offsets(partitions.size() + 1, 0);
+    for (std::size_t i = 0; i < partitions.size(); ++i)
+        offsets[i + 1] = offsets[i] + partitions[i].size();
+
+    std::vector<ServiceRequest> records(validRecords);
+    const long long NP = static_cast<long long>(partitions.size());
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (long long i = 0; i < NP; ++i) {
+        auto& part = partitions[static_cast<std::size_t>(i)];
+        std::move(part.begin(), part.end(),
+                  records.begin() + static_cast<std::ptrdiff_t>(offsets[static_cast<std::size_t>(i)]));
+        std::vector<ServiceRequest>().swap(part);
     }
 
     auto end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> dur = end - start;
     std::cout << "Loaded " << validRecords << " records in " << dur.count() << " seconds\n";
-    std::cout << "Total lines processed: " << lineCount << "\n";
+    std::cout << "Total bytes processed: " << pos << "\n";
     return records;
 }
 
+// The queries below run on the shared ThreadPool (64K-row morsels, work
+// stealing). Filters select row ids per morsel and then copy the matching
+// records in row order.
+static std::vector<ServiceRequest> gatherRecords(const std::vector<std::size_t>& rows) {
+    std::vector<ServiceRequest> out(rows.size());
+    ThreadPool::global().forEachMorsel(rows.size(), [&](const ThreadPool::Morsel& m, unsigned) {
+        for (std::size_t i = m.begin; i < m.end; ++i) out[i] = g_records[rows[i]];
+    }, 4096);
+    return out;
+}
+
 std::vector<ServiceRequest> filterByCreatedDateRange(const DateTime& start,
                                                      const DateTime& end) {
-    int T = omp_get_max_threads();
-    int n = static_cast<int>(g_records.size());
-
-    std::vector<std::vector<ServiceRequest>> localResults(T);
-
-    #pragma omp parallel for schedule(static)
-    for (int i = 0; i < n; ++i) {
-        if (g_records[i].createdDate >= start && g_records[i].createdDate <= end) {
-            int t = omp_get_thread_num();
-            localResults[t].push_back(g_records[i]);
-        }
-    }
-
-    std::vector<ServiceRequest> out;
-    for (int t = 0; t < T; ++t)
-        out.insert(out.end(), localResults[t].begin(), localResults[t].end());
-    return out;
+    return gatherRecords(ThreadPool::global().select(g_records.size(),
+        [&](std::size_t begin, std::size_t stop, std::size_t* out) {
+            std::size_t n = 0;
+            for (std::size_t i = begin; i < stop; ++i)
+                if (g_records[i].createdDate >= start && g_records[i].createdDate <= end) out[n++] = i;
+            return n;
+        }));
 }
 
 std::vector<ServiceRequest> filterByBorough(const std::string& borough) {
-    int T = omp_get_max_threads();
-    int n = static_cast<int>(g_records.size());
-    std::vector<std::vector<ServiceRequest>> localResults(T);
-
     std::string target = borough;
     for (auto& c : target) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
 
-    #pragma omp parallel for schedule(static)
-    for (int i = 0; i < n; ++i) {
-        std::string b = g_records[i].borough;
-        for (auto& c : b) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
-        if (b == target) {
-            int t = omp_get_thread_num();
-            localResults[t].push_back(g_records[i]);
-        }
-    }
-
-    std::vector<ServiceRequest> out;
-    for (int t = 0; t < T; ++t)
-        out.insert(out.end(), localResults[t].begin(), localResults[t].end());
-    return out;
+    return gatherRecords(ThreadPool::global().select(g_records.size(),
+        [&](std::size_t begin, std::size_t end, std::size_t* out) {
+            std::size_t n = 0;
+            std::string b;
+            for (std::size_t i = begin; i < end; ++i) {
+                b = g_records[i].borough;
+                for (auto& c : b) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+                if (b == target) out[n++] = i;
+            }
+            return n;
+        }));
 }
 
 std::vector<ServiceRequest> searchByComplaint(const std::string& keyword) {
-    int T = omp_get_max_threads();
-    int n = static_cast<int>(g_records.size());
-    std::vector<std::vector<ServiceRequest>> localResults(T);
-
     std::string key = keyword;
     for (auto& c : key) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
 
-    #pragma omp parallel for schedule(static)
-    for (int i = 0; i < n; ++i) {
-        std::string comp = g_records[i].complaintType;
-        for (auto& c : comp) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
-        if (comp.find(key) != std::string::npos) {
-            int t = omp_get_thread_num();
-            localResults[t].push_back(g_records[i]);
-        }
-    }
-
-    std::vector<ServiceRequest> out;
-    for (int t = 0; t < T; ++t)
-        out.insert(out.end(), localResults[t].begin(), localResults[t].end());
-    return out;
+    return gatherRecords(ThreadPool::global().select(g_records.size(),
+        [&](std::size_t begin, std::size_t end, std::size_t* out) {
+            std::size_t n = 0;
+            std::string comp;
+            for (std::size_t i = begin; i < end; ++i) {
+                comp = g_records[i].complaintType;
+                for (auto& c : comp) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+                if (comp.find(key) != std::string::npos) out[n++] = i;
+            }
+            return n;
+        }));
 }
 
 std::vector<const ServiceRequest*> filterByLatLonBox(double minLat, double maxLat,
                                                      double minLon, double maxLon) {
-    int T = omp_get_max_threads();
-    int n = static_cast<int>(g_records.size());
-    std::vector<std::vector<const ServiceRequest*>> localResults(T);
-
-    #pragma omp parallel for schedule(static)
-    for (int i = 0; i < n; ++i) {
-        if (g_records[i].latitude  >= minLat && g_records[i].latitude  <= maxLat &&
-            g_records[i].longitude >= minLon && g_records[i].longitude <= maxLon) {
-            int t = omp_get_thread_num();
-            localResults[t].push_back(&g_records[i]);
-        }
-    }
+    // Small boxes: only the grid cells under the box are visited; large
+    // ones scan on the pool
+    std::vector<std::size_t> rows;
+    if (!g_grid.query({minLat, maxLat, minLon, maxLon},
+                      [](std::size_t i) { return g_records[i].latitude; },
+                      [](std::size_t i) { return g_records[i].longitude; }, rows))
+        rows = ThreadPool::global().select(g_records.size(),
+            [&](std::size_t begin, std::size_t end, std::size_t* out) {
+                std::size_t n = 0;
+                for (std::size_t i = begin; i < end; ++i) {
+                    if (g_records[i].latitude  >= minLat && g_records[i].latitude  <= maxLat &&
+                        g_records[i].longitude >= minLon && g_records[i].longitude <= maxLon) out[n++] = i;
+                }
+                return n;
+            });
 
-    std::vector<const ServiceRequest*> out;
-    for (int t = 0; t < T; ++t)
-        out.insert(out.end(), localResults[t].begin(), localResults[t].end());
+    std::vector<const ServiceRequest*> out(rows.size());
+    for (std::size_t i = 0; i < rows.size(); ++i) out[i] = &g_records[rows[i]];
     return out;
 }
 
 double averageLatitude() {
     if (g_records.empty()) return 0.0;
-    int n = static_cast<int>(g_records.size());
-    double sum = 0.0;
+    const std::size_t n = g_records.size();
+
+    // Per-morsel (sum, count) pairs, added in morsel order (deterministic).
+    // Rows without a latitude (left at 0.0) are not averaged in.
+    std::vector<std::pair<double, std::size_t>> partial(ThreadPool::morselCount(n), {0.0, 0});
+    ThreadPool::global().forEachMorsel(n, [&](const ThreadPool::Morsel& m, unsigned) {
+        double sum = 0.0;
+        std::size_t count = 0;
+        for (std::size_t i = m.begin; i < m.end; ++i) {
+            const double lat = g_records[i].latitude;
+            sum += lat;
+            count += lat != 0.0;
+        }
+        partial[m.index] = {sum, count};
+    });
 
-    #pragma omp parallel for reduction(+:sum)
-    for (int i = 0; i < n; ++i) {
-        sum += g_records[i].latitude;
+    double sum = 0.0;
+    std::size_t count = 0;
+    for (const auto& p : partial) {
+        sum += p.first;
+        count += p.second;
     }
-
-    return sum / static_cast<double>(g_records.size());
+    return count ? sum / static_cast<double>(count) : 0.0;
 }
 
 struct ZoneStats {
@@ -370,26 +317,49 @@ std::map<std::string, ZoneStats> aggregateByBorough_omp_critical() {
     return result;
 }
 
-// Merge helper
-static void mergeZoneStats(ZoneStats& dst, const ZoneStats& src) {
-    dst.totalCount += src.totalCount;
-    for (const auto& kv : src.byComplaintType) dst.byComplaintType[kv.first] += kv.second;
-    for (const auto& kv : src.byAgency)        dst.byAgency[kv.first]        += kv.second;
-    for (const auto& kv : src.byStatus)        dst.byStatus[kv.first]        += kv.second;
-}
+// Faster scaling version: per-worker unordered_map (kept across calls by
+// the pool, only cleared), then a radix-partitioned two-phase merge:
+//  1) each worker scatters its (borough, field, value) counts into
+//     kMergePartitions lists by key hash
+//  2) each partition is merged across all workers by its own pool task
+// Only the merged distinct keys are folded into the result on one thread,
+// so the serial part no longer grows with the worker count.
+static constexpr unsigned kPartitionBits = 6;
+static constexpr std::size_t kMergePartitions = std::size_t(1) << kPartitionBits;
+static constexpr char kKeySep = '\x1f';
+
+// Merge key "borough<sep><tag>value" (tag T = total, C/A/S = field) with its
+// hash computed once: the top bits pick the partition, the map reuses it
+struct PartitionKey {
+    std::string text;
+    std::size_t hash = 0;
+
+    PartitionKey(const std::string& borough, char tag, const std::string& value) {
+        text.reserve(borough.size() + 2 + value.size());
+        text.append(borough).push_back(kKeySep);
+        text.push_back(tag);
+        text.append(value);
+        hash = std::hash<std::string>{}(text);
+    }
+    std::size_t partition() const { return hash >> (8 * sizeof(std::size_t) - kPartitionBits); }
+    bool operator==(const PartitionKey& o) const { return hash == o.hash && text == o.text; }
+};
+struct PartitionKeyHash {
+    std::size_t operator()(const PartitionKey& k) const { return k.hash; }
+};
 
-// Faster scaling version: thread-local unordered_map, then merge
 std::map<std::string, ZoneStats> aggregateByBorough_omp_fast() {
-    int T = omp_get_max_threads();
-    std::vector<std::unordered_map<std::string, ZoneStats>> local(static_cast<std::size_t>(T));
-
-    #pragma omp parallel
-    {
-        int tid = omp_get_thread_num();
-        auto& mp = local[static_cast<std::size_t>(tid)];
-
-        #pragma omp for schedule(static)
-        for (std::size_t i = 0; i < g_records.size(); ++i) {
+    using Scattered = std::vector<std::vector<std::pair<PartitionKey, std::size_t>>>;
+    using Counts = std::unordered_map<PartitionKey, std::size_t, PartitionKeyHash>;
+    ThreadPool& pool = ThreadPool::global();
+    static WorkerLocal<std::unordered_map<std::string, ZoneStats>> local(pool.capacity());
+    static std::vector<Scattered> scattered(pool.capacity(), Scattered(kMergePartitions));
+    static std::vector<Counts> merged(kMergePartitions);
+    for (unsigned w = 0; w < local.size(); ++w) local[w].clear();
+
+    pool.forEachMorsel(g_records.size(), [&](const ThreadPool::Morsel& m, unsigned w) {
+        auto& mp = local[w];
+        for (std::size_t i = m.begin; i < m.end; ++i) {
             const auto& r = g_records[i];
             const std::string key = r.borough.empty() ? "(unknown)" : r.borough;
 
@@ -399,12 +369,49 @@ std::map<std::string, ZoneStats> aggregateByBorough_omp_fast() {
             if (!r.agency.empty())        z.byAgency[r.agency]++;
             if (!r.status.empty())        z.byStatus[r.status]++;
         }
-    }
+    });
+
+    // Phase 1: scatter, one task per worker's map
+    pool.forEachMorsel(local.size(), [&](const ThreadPool::Morsel& m, unsigned) {
+        for (std::size_t w = m.begin; w < m.end; ++w) {
+            Scattered& out = scattered[w];
+            for (auto& part : out) part.clear();
+            auto emit = [&](const std::string& borough, char tag, const std::string& value, std::size_t count) {
+                PartitionKey key(borough, tag, value);
+                out[key.partition()].emplace_back(std::move(key), count);
+            };
+            for (const auto& kv : local[w]) {
+                emit(kv.first, 'T', std::string(), kv.second.totalCount);
+                for (const auto& c : kv.second.byComplaintType) emit(kv.first, 'C', c.first, c.second);
+                for (const auto& c : kv.second.byAgency)        emit(kv.first, 'A', c.first, c.second);
+                for (const auto& c : kv.second.byStatus)        emit(kv.first, 'S', c.first, c.second);
+            }
+        }
+    }, 1);
+
+    // Phase 2: merge, one task per partition
+    pool.forEachMorsel(kMergePartitions, [&](const ThreadPool::Morsel& m, unsigned) {
+        for (std::size_t p = m.begin; p < m.end; ++p) {
+            Counts& dst = merged[p];
+            dst.clear();
+            for (const Scattered& src : scattered)
+                for (const auto& kv : src[p]) dst[kv.first] += kv.second;
+        }
+    }, 1);
 
     std::map<std::string, ZoneStats> result;
-    for (auto& mp : local) {
-        for (auto& kv : mp) {
-            mergeZoneStats(result[kv.first], kv.second);
+    for (const Counts& part : merged) {
+        for (const auto& kv : part) {
+            const std::string& text = kv.first.text;
+            const std::size_t sep = text.find(kKeySep);
+            ZoneStats& z = result[text.substr(0, sep)];
+            const std::string value = text.substr(sep + 2);
+            switch (text[sep + 1]) {
+                case 'T': z.totalCount += kv.second; break;
+                case 'C': z.byComplaintType[value] += kv.second; break;
+                case 'A': z.byAgency[value] += kv.second; break;
+                case 'S': z.byStatus[value] += kv.second; break;
+            }
         }
     }
     return result;
@@ -442,39 +449,78 @@ void printTopZones(const MapT& zones) {
 
 int main(int argc, char* argv[]) { 
     std::string filename =
-        (argc > 1) ? argv[1]
-                   : "/Users/aravindreddy/Downloads/SJSU ClassWork/275 EAD/Mini1_Datasets/311_combined.csv.";
+        "/Users/aravindreddy/Downloads/SJSU ClassWork/275 EAD/Mini1_Datasets/311_combined.csv.";
+
+    // Usage: ./main [csv_file] [--sweep]
+    bool sweep = false;
+    bool haveFile = false;
+    for (int a = 1; a < argc; ++a) {
+        std::string arg = argv[a];
+        if (arg == "--sweep") sweep = true;
+        else if (!haveFile) { filename = arg; haveFile = true; }
+    }
 
-    std::cout << "Using threads (OpenMP): " << omp_get_max_threads() << "\n";
+    std::cout << "Using threads (OpenMP load): " << omp_get_max_threads()
+              << ", query pool: " << ThreadPool::global().size() << " workers\n";
 
-    double memBefore = rssMemMB();
-    std::cout << "Memory before load: " << memBefore << " MB\n";
+    const MemStats memBefore = readMemStats();
+    printMemStats("Memory before load", memBefore);
 
     g_records = loadDataParallel(filename);
 
-    double memAfter = rssMemMB();
-    std::cout << "Memory after load: " << memAfter << " MB\n";
-    std::cout << "Memory delta: " << (memAfter - memBefore) << " MB\n";
+    const MemStats memAfter = readMemStats();
+    printMemStats("Memory after load", memAfter);
+    const double mb = 1024.0 * 1024.0;
+    std::cout << "Memory delta: " << (double(memAfter.rss) - double(memBefore.rss)) / mb << " MB"
+              << " (anon " << (double(memAfter.anon) - double(memBefore.anon)) / mb << " MB)" << "\n";
 
     if (g_records.empty()) {
         std::cerr << "No records loaded. Exiting.\n";
         return 1;
     }
 
+    auto gridStart = std::chrono::high_resolution_clock::now();
+    g_grid.build(g_records.size(),
+                 [](std::size_t i) { return g_records[i].latitude; },
+                 [](std::size_t i) { return g_records[i].longitude; });
+    std::chrono::duration<double> gridTime = std::chrono::high_resolution_clock::now() - gridStart;
+    std::cout << "Lat/lon grid index built in " << gridTime.count() << " seconds\n";
+
     std::cout << std::fixed << std::setprecision(6);
 
     const int runs = 15;
     const std::size_t sampleN = 5;
 
+    // Every query walks the whole record array; each record read pulls in at
+    // least one 64-byte cache line, however few of its fields are used
+    const double rows = static_cast<double>(g_records.size());
+    const ScanVolume fullScan{rows, rows * 64};
+    setBenchmarkContext("multi_thread", ThreadPool::global().size());
+
+    DateTime start = DateTime::parse("01/01/2013 12:00:00 AM");
+    DateTime end   = DateTime::parse("12/31/2013 11:59:59 PM");
+
+    // --sweep: the six queries at 1, 2, 4, ... pool workers instead of the
+    // normal run
+    if (sweep) {
+        runThreadSweep({
+            sweepQuery("date range 2013", [&]() { return filterByCreatedDateRange(start, end); }, fullScan),
+            sweepQuery("borough BROOKLYN", [&]() { return filterByBorough("BROOKLYN"); }, fullScan),
+            sweepQuery("complaint 'rodent'", [&]() { return searchByComplaint("rodent"); }, fullScan),
+            sweepQuery("lat/lon box", [&]() { return filterByLatLonBox(40.5, 40.9, -74.25, -73.7); }, fullScan),
+            sweepQuery("average latitude", [&]() { return averageLatitude(); }, fullScan),
+            sweepQuery("borough aggregation (omp fast)", [&]() { return aggregateByBorough_omp_fast(); }, fullScan),
+        }, runs);
+        writeBenchmarkReports();
+        return 0;
+    }
+
     std::cout << "\n=== Query Outputs ===\n";
 
     // Query 1
     std::cout << "\n[Query 1] Date Range - Filtering service requests created in calendar year 2013.\n"
               << "This query scans all records and selects those whose createdDate falls within the specified range.\n";
 
-    DateTime start = DateTime::parse("01/01/2013 12:00:00 AM");
-    DateTime end   = DateTime::parse("12/31/2013 11:59:59 PM");
-
     benchmark("date range 2013", runs,
         [&](){ return filterByCreatedDateRange(start, end); },
         sampleN,
@@ -483,7 +529,8 @@ int main(int argc, char* argv[]) {
                       << " created=" << r.createdDate.toString()
                       << " borough=" << r.borough
                       << "\n";
-        }
+        },
+        fullScan
     );
 
     // Query 2
@@ -498,7 +545,8 @@ int main(int argc, char* argv[]) {
                       << " borough=" << r.borough
                       << " complaint=" << r.complaintType
                       << "\n";
-        }
+        },
+        fullScan
     );
 
     // Query 3
@@ -513,7 +561,8 @@ int main(int argc, char* argv[]) {
                       << " complaint=" << r.complaintType
                       << " borough=" << r.borough
                       << "\n";
-        }
+        },
+        fullScan
     );
 
     // Query 4
@@ -529,15 +578,18 @@ int main(int argc, char* argv[]) {
                       << " lat=" << r->latitude
                       << " lon=" << r->longitude
                       << "\n";
-        }
+        },
+        fullScan
     );
 
     // Query 5
     std::cout << "\n[Query 5] Average Latitude - Computing average latitude of all loaded service requests.\n"
-              << "This demonstrates a full-dataset aggregation (reduce operation) using OpenMP reduction.\n";
+              << "This demonstrates a full-dataset aggregation (reduce operation) as per-morsel partial sums on the thread pool.\n"
+              << "Rows without a latitude are left out of the sum and the count.\n";
 
     benchmark("average latitude", runs,
-        [&](){ return averageLatitude(); }
+        [&](){ return averageLatitude(); },
+        fullScan
     );
 
     // Query 6
@@ -548,11 +600,13 @@ int main(int argc, char* argv[]) {
     (void)aggregateByBorough_omp_fast();
 
     auto agg_fast = benchmark("borough aggregation (omp fast)", runs,
-        [&](){ return aggregateByBorough_omp_fast(); }
+        [&](){ return aggregateByBorough_omp_fast(); },
+        fullScan
     );
 
     std::cout << "\n Borough Totals + Top Complaint -\n";
     printTopZones(agg_fast);
 
+    writeBenchmarkReports();
     return 0;
 }
\ No newline at end of file
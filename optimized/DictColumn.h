@@ -0,0 +1,165 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "../common/MemStats.h"
+
+// Dictionary-encoded string column for low-cardinality fields (borough,
+// agency, status, ...). Each row stores a small integer code; the distinct
+// strings live once in the dictionary. Code 0 is always the empty string,
+// so "is empty" is a code compare.
+//
+// Reads look like a vector<string> (`col[i]` returns the decoded string),
+// while queries can compare and group on `codes()` directly.
+template <typename Code>
+class DictColumn {
+   static_assert(std::is_unsigned<Code>::value, "dictionary codes must be unsigned");
+
+public:
+   using code_type = Code;
+   using value_type = std::string;
+
+   // Largest number of distinct values (including "") the code type can hold
+   static constexpr std::size_t kMaxEntries = std::size_t(std::numeric_limits<Code>::max()) + 1;
+
+   DictColumn() { clear(); }
+
+   DictColumn(const DictColumn& other) : codes_(other.codes_), dict_(other.dict_) { reindex(); }
+   DictColumn& operator=(const DictColumn& other) {
+      if (this != &other) {
+         codes_ = other.codes_;
+         dict_ = other.dict_;
+         reindex();
+      }
+      return *this;
+   }
+   // Moving a vector keeps its element buffer, so the index views stay valid
+   DictColumn(DictColumn&&) = default;
+   DictColumn& operator=(DictColumn&&) = default;
+
+   std::size_t size() const { return codes_.size(); }
+   bool empty() const { return codes_.empty(); }
+   void reserve(std::size_t rows) { codes_.reserve(rows); }
+
+   // Decoded value of row i
+   const std::string& operator[](std::size_t i) const { return dict_[codes_[i]]; }
+   Code code(std::size_t i) const { return codes_[i]; }
+
+   const std::vector<Code>& codes() const { return codes_; }
+   const std::vector<std::string>& dictionary() const { return dict_; }
+
+   // Heap bytes: codes, dictionary strings and the lookup index (its nodes
+   // estimated as entry + next pointer + cached hash)
+   std::size_t memoryBytes() const {
+      return allocatedBytes(codes_) + allocatedBytes(dict_) + index_.bucket_count() * sizeof(void*) +
+             index_.size() * (sizeof(typename decltype(index_)::value_type) + 2 * sizeof(void*));
+   }
+
+   // Appends one row. Returns false (and appends nothing) if the value is
+   // new and the dictionary is already full for this code width.
+   bool push_back(std::string_view v) {
+      Code c;
+      if (!intern(v, c)) return false;
+      codes_.push_back(c);
+      return true;
+   }
+
+   // Code for v, adding it to the dictionary if needed
+   bool intern(std::string_view v, Code& out) {
+      auto it = index_.find(v);
+      if (it != index_.end()) {
+         out = it->second;
+         return true;
+      }
+      if (dict_.size() >= kMaxEntries) return false;
+
+      // Growing the dictionary moves its strings; rebuild the views after
+      if (dict_.size() == dict_.capacity()) {
+         dict_.reserve(dict_.capacity() < 16 ? 16 : dict_.capacity() * 2);
+         reindex();
+      }
+      out = static_cast<Code>(dict_.size());
+      dict_.emplace_back(v);
+      index_.emplace(dict_.back(), out);
+      return true;
+   }
+
+   // Appends the first `count` rows of another column, re-coding them into
+   // this dictionary. Values are interned in order of first use, as if the
+   // rows had been pushed one by one. Returns false (appending nothing) if
+   // the dictionary overflows.
+   bool append(const DictColumn& other, std::size_t count) {
+      constexpr uint32_t kUnmapped = ~uint32_t(0);
+      std::vector<uint32_t> remap(other.dict_.size(), kUnmapped);
+      const std::size_t oldSize = codes_.size();
+      for (std::size_t i = 0; i < count; ++i) {
+         const Code c = other.codes_[i];
+         if (remap[c] == kUnmapped) {
+            Code mapped;
+            if (!intern(other.dict_[c], mapped)) {
+               codes_.resize(oldSize);
+               return false;
+            }
+            remap[c] = mapped;
+         }
+         codes_.push_back(static_cast<Code>(remap[c]));
+      }
+      return true;
+   }
+
+   // Code for v without modifying the dictionary; false if v never occurs
+   bool find(std::string_view v, Code& out) const {
+      auto it = index_.find(v);
+      if (it == index_.end()) return false;
+      out = it->second;
+      return true;
+   }
+
+   // Drops the rows but keeps the dictionary, so codes stay comparable
+   // across batches of the same file
+   void clearRows() { codes_.clear(); }
+
+   void clear() {
+      codes_.clear();
+      dict_.clear();
+      index_.clear();
+      dict_.reserve(16);
+      dict_.emplace_back();
+      index_.emplace(dict_.back(), Code(0));
+   }
+
+   // Bulk restore (snapshot load). The dictionary must start with "" and
+   // hold no duplicates; every code must be < dictionary size.
+   bool assign(std::vector<Code> codes, std::vector<std::string> dict) {
+      if (dict.empty() || !dict[0].empty() || dict.size() > kMaxEntries) return false;
+      for (Code c : codes)
+         if (c >= dict.size()) return false;
+      codes_ = std::move(codes);
+      dict_ = std::move(dict);
+      reindex();
+      return index_.size() == dict_.size();
+   }
+
+private:
+   void reindex() {
+      index_.clear();
+      index_.reserve(dict_.size());
+      for (std::size_t c = 0; c < dict_.size(); ++c)
+         index_.emplace(dict_[c], static_cast<Code>(c));
+   }
+
+   std::vector<Code> codes_;
+   std::vector<std::string> dict_;
+   std::unordered_map<std::string_view, Code> index_;   // views into dict_
+};
+
+template <typename T>
+struct isDictColumn : std::false_type {};
+template <typename Code>
+struct isDictColumn<DictColumn<Code>> : std::true_type {};
@@ -0,0 +1,485 @@
+#include "GroupBy.h"
+#include "../common/ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <numeric>
+
+// Dense per-worker arrays up to this many key combinations
+static constexpr std::size_t kDenseGroups = std::size_t(1) << 16;
+// Rows handled per inner pass (keys, then counts, then each aggregate)
+static constexpr std::size_t kChunkRows = 1024;
+// Hash path: groups are merged in 2^kPartitionBits independent partitions
+static constexpr unsigned kPartitionBits = 5;
+static constexpr std::size_t kPartitions = std::size_t(1) << kPartitionBits;
+
+// Calls f(j, value) for rows [begin, begin + len) of a column, j = row - begin
+template <typename F>
+static void forChunk(ColumnKind kind, const void* data, std::size_t begin, std::size_t len, F&& f) {
+    switch (kind) {
+        case ColumnKind::U8:  { const auto* p = static_cast<const uint8_t*>(data) + begin;  for (std::size_t j = 0; j < len; ++j) f(j, p[j]); break; }
+        case ColumnKind::U16: { const auto* p = static_cast<const uint16_t*>(data) + begin; for (std::size_t j = 0; j < len; ++j) f(j, p[j]); break; }
+        case ColumnKind::U32: { const auto* p = static_cast<const uint32_t*>(data) + begin; for (std::size_t j = 0; j < len; ++j) f(j, p[j]); break; }
+        case ColumnKind::U64: { const auto* p = static_cast<const uint64_t*>(data) + begin; for (std::size_t j = 0; j < len; ++j) f(j, p[j]); break; }
+        case ColumnKind::I16: { const auto* p = static_cast<const int16_t*>(data) + begin;  for (std::size_t j = 0; j < len; ++j) f(j, p[j]); break; }
+        case ColumnKind::I32: { const auto* p = static_cast<const int32_t*>(data) + begin;  for (std::size_t j = 0; j < len; ++j) f(j, p[j]); break; }
+        case ColumnKind::F64: { const auto* p = static_cast<const double*>(data) + begin;   for (std::size_t j = 0; j < len; ++j) f(j, p[j]); break; }
+    }
+}
+
+static inline bool validAt(const uint64_t* valid, std::size_t row) {
+    return (valid[row / 64] >> (row % 64)) & 1;
+}
+
+static unsigned widthOf(ColumnKind kind) {
+    switch (kind) {
+        case ColumnKind::U8:  return 8;
+        case ColumnKind::U16: case ColumnKind::I16: return 16;
+        case ColumnKind::U32: case ColumnKind::I32: return 32;
+        default: return 64;
+    }
+}
+
+static bool isSigned(ColumnKind kind) { return kind == ColumnKind::I16 || kind == ColumnKind::I32; }
+
+// Key value as unsigned bits that sort like the value (signed: sign bit
+// flipped). Floating-point keys are rejected before any row is read.
+template <typename T>
+static inline uint64_t orderedBits(T v) {
+    if constexpr (std::is_floating_point<T>::value) {
+        return 0;
+    } else if constexpr (std::is_signed<T>::value) {
+        using U = typename std::make_unsigned<T>::type;
+        return uint64_t(U(static_cast<U>(v) ^ (U(1) << (sizeof(T) * 8 - 1))));
+    } else {
+        return static_cast<uint64_t>(v);
+    }
+}
+
+// Inverse of orderedBits for a key of `kind`, as int64 bits
+static uint64_t keyValueOf(ColumnKind kind, uint64_t bits) {
+    switch (kind) {
+        case ColumnKind::I16: return static_cast<uint64_t>(int64_t(int16_t(uint16_t(bits ^ 0x8000u))));
+        case ColumnKind::I32: return static_cast<uint64_t>(int64_t(int32_t(uint32_t(bits ^ 0x80000000u))));
+        default: return bits;
+    }
+}
+
+static inline uint64_t mixHash(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+static double identityOf(AggOp op) {
+    switch (op) {
+        case AggOp::Min: return std::numeric_limits<double>::infinity();
+        case AggOp::Max: return -std::numeric_limits<double>::infinity();
+        default: return 0.0;
+    }
+}
+
+// Merges two partial states. Count slots only hold the hidden non-null
+// counts (see groupBy), which add like sums.
+static inline void combine(AggOp op, double& into, double v) {
+    switch (op) {
+        case AggOp::Min: if (v < into) into = v; break;
+        case AggOp::Max: if (v > into) into = v; break;
+        default: into += v; break;
+    }
+}
+
+namespace {
+
+// How keys turn into a group id (dense) or a packed 64-bit key (hash)
+struct KeyLayout {
+    bool dense = false;
+    std::size_t groups = 0;                 // dense: product of dictionary sizes
+    std::vector<uint64_t> stride;           // dense: mixed-radix place value
+    std::vector<uint64_t> cardinality;      // dense: dictionary sizes
+    std::vector<unsigned> shift, bits;      // hash: bit field of each key (top bit = null flag
+                                            // for keys with a validity bitmap)
+};
+
+// Group states of one worker or partition: packed key, row count and one
+// double per aggregate, indexed by slot
+struct Arena {
+    std::vector<uint64_t> keys;
+    std::vector<uint64_t> counts;
+    std::vector<double>   values;
+
+    uint32_t add(uint64_t key, const std::vector<Aggregate>& aggs) {
+        keys.push_back(key);
+        counts.push_back(0);
+        for (const auto& a : aggs) values.push_back(identityOf(a.op));
+        return static_cast<uint32_t>(keys.size() - 1);
+    }
+};
+
+// Open-addressing (linear probing) map: packed key -> arena slot
+struct HashTable {
+    std::vector<uint64_t> keys;
+    std::vector<uint32_t> slots;   // UINT32_MAX = empty
+    std::size_t used = 0;
+
+    void reset(std::size_t capacity) {
+        keys.assign(capacity, 0);
+        slots.assign(capacity, UINT32_MAX);
+        used = 0;
+    }
+
+    // Slot of `key`, creating it in `arena` if new; `isNew` tells which
+    uint32_t findOrAdd(uint64_t key, uint64_t hash, Arena& arena, const std::vector<Aggregate>& aggs, bool& isNew) {
+        if ((used + 1) * 2 > keys.size()) grow(arena);
+        const std::size_t mask = keys.size() - 1;
+        for (std::size_t p = hash & mask;; p = (p + 1) & mask) {
+            if (slots[p] == UINT32_MAX) {
+                keys[p] = key;
+                slots[p] = arena.add(key, aggs);
+                ++used;
+                isNew = true;
+                return slots[p];
+            }
+            if (keys[p] == key) {
+                isNew = false;
+                return slots[p];
+            }
+        }
+    }
+
+    void grow(const Arena& arena) {
+        reset(keys.empty() ? 1024 : keys.size() * 2);
+        const std::size_t mask = keys.size() - 1;
+        for (uint32_t s = 0; s < arena.keys.size(); ++s) {
+            std::size_t p = mixHash(arena.keys[s]) & mask;
+            while (slots[p] != UINT32_MAX) p = (p + 1) & mask;
+            keys[p] = arena.keys[s];
+            slots[p] = s;
+            ++used;
+        }
+    }
+};
+
+struct WorkerState {
+    Arena arena;
+    HashTable table;
+    std::vector<uint32_t> partitionSlots[kPartitions];   // hash path: slots by partition
+};
+
+} // namespace
+
+static bool planKeys(const std::vector<GroupKey>& keys, KeyLayout& layout) {
+    // Dense if every key is a dictionary and the combinations stay small
+    layout.dense = true;
+    std::size_t groups = 1;
+    for (const auto& k : keys) {
+        if (!k.dictionary || groups * k.dictionary->size() > kDenseGroups) { layout.dense = false; break; }
+        groups *= k.dictionary->size();
+    }
+    if (layout.dense) {
+        layout.groups = groups;
+        layout.stride.assign(keys.size(), 1);
+        layout.cardinality.resize(keys.size());
+        for (std::size_t k = keys.size(); k-- > 0;) {
+            layout.cardinality[k] = keys[k].dictionary->size();
+            if (k + 1 < keys.size()) layout.stride[k] = layout.stride[k + 1] * layout.cardinality[k + 1];
+        }
+        return true;
+    }
+
+    // Hash: pack each key into its own bit field, first key on top
+    unsigned total = 0;
+    layout.bits.resize(keys.size());
+    layout.shift.resize(keys.size());
+    for (std::size_t k = 0; k < keys.size(); ++k) {
+        unsigned b = widthOf(keys[k].kind);
+        if (keys[k].dictionary) {
+            b = 1;
+            while ((uint64_t(1) << b) < keys[k].dictionary->size()) ++b;
+        }
+        if (keys[k].valid) ++b;
+        layout.bits[k] = b;
+        total += b;
+    }
+    if (total > 64) {
+        std::cerr << "Error: group-by keys need " << total << " bits; at most 64 are supported\n";
+        return false;
+    }
+    unsigned shift = total;
+    for (std::size_t k = 0; k < keys.size(); ++k) {
+        shift -= layout.bits[k];
+        layout.shift[k] = shift;
+    }
+    return true;
+}
+
+// Adds rows [begin, begin + len) of every aggregate into `values` / `counts`
+// at the slots in idx[]. A Count with a validity bitmap counts non-null rows.
+static void accumulateChunk(const std::vector<Aggregate>& aggs, std::size_t begin, std::size_t len,
+                            const uint32_t* idx, uint64_t* counts, double* values) {
+    const std::size_t A = aggs.size();
+    for (std::size_t j = 0; j < len; ++j) counts[idx[j]]++;
+    for (std::size_t a = 0; a < A; ++a) {
+        const Aggregate& agg = aggs[a];
+        double* v = values + a;
+        switch (agg.op) {
+            case AggOp::Count:
+                if (agg.valid)
+                    for (std::size_t j = 0; j < len; ++j) v[idx[j] * A] += validAt(agg.valid, begin + j);
+                break;
+            case AggOp::Min:
+                if (agg.valid) {
+                    forChunk(agg.kind, agg.data, begin, len, [&](std::size_t j, auto x) {
+                        double& m = v[idx[j] * A];
+                        if (validAt(agg.valid, begin + j) && double(x) < m) m = double(x);
+                    });
+                    break;
+                }
+                forChunk(agg.kind, agg.data, begin, len, [&](std::size_t j, auto x) {
+                    double& m = v[idx[j] * A];
+                    if (double(x) < m) m = double(x);
+                });
+                break;
+            case AggOp::Max:
+                if (agg.valid) {
+                    forChunk(agg.kind, agg.data, begin, len, [&](std::size_t j, auto x) {
+                        double& m = v[idx[j] * A];
+                        if (validAt(agg.valid, begin + j) && double(x) > m) m = double(x);
+                    });
+                    break;
+                }
+                forChunk(agg.kind, agg.data, begin, len, [&](std::size_t j, auto x) {
+                    double& m = v[idx[j] * A];
+                    if (double(x) > m) m = double(x);
+                });
+                break;
+            case AggOp::Sum:
+            case AggOp::Avg:
+                // null rows hold 0, so they add nothing
+                forChunk(agg.kind, agg.data, begin, len, [&](std::size_t j, auto x) { v[idx[j] * A] += double(x); });
+                break;
+        }
+    }
+}
+
+// Finishes one group into `out`: decoded keys, count, final values.
+// nonNull[a] is the slot counting aggregate a's non-null rows, or SIZE_MAX
+// if its column has no nulls.
+static void emitGroup(const std::vector<GroupKey>& keys, const std::vector<Aggregate>& aggs,
+                      const std::vector<std::size_t>& nonNull, const KeyLayout& layout, uint64_t key,
+                      uint64_t count, const double* values, GroupByResult& out) {
+    for (std::size_t k = 0; k < keys.size(); ++k) {
+        if (layout.dense) {
+            out.keyValues.push_back((key / layout.stride[k]) % layout.cardinality[k]);
+            out.keyNulls.push_back(0);
+        } else {
+            const uint64_t mask = layout.bits[k] == 64 ? ~uint64_t(0) : (uint64_t(1) << layout.bits[k]) - 1;
+            uint64_t field = (key >> layout.shift[k]) & mask;
+            bool isNull = false;
+            if (keys[k].valid) {
+                isNull = (field >> (layout.bits[k] - 1)) != 0;
+                field &= (uint64_t(1) << (layout.bits[k] - 1)) - 1;
+            }
+            out.keyValues.push_back(isNull ? 0 : keys[k].dictionary ? field : keyValueOf(keys[k].kind, field));
+            out.keyNulls.push_back(isNull);
+        }
+    }
+    out.counts.push_back(count);
+    for (std::size_t a = 0; a < aggs.size(); ++a) {
+        double v = values[a];
+        const double rows = nonNull[a] == SIZE_MAX ? double(count) : values[nonNull[a]];
+        if (aggs[a].op == AggOp::Count) v = aggs[a].valid ? v : double(count);   // COUNT(col) / COUNT(*)
+        else if (rows == 0) v = std::numeric_limits<double>::quiet_NaN();
+        else if (aggs[a].op == AggOp::Avg) v /= rows;
+        out.values.push_back(v);
+    }
+}
+
+bool groupBy(const std::vector<GroupKey>& keys, const std::vector<Aggregate>& aggregates,
+             GroupByResult& out) {
+    out = GroupByResult{};
+    out.keys = keys;
+    out.aggregates = aggregates;
+
+    if (keys.empty()) {
+        std::cerr << "Error: group-by needs at least one key column\n";
+        return false;
+    }
+    const std::size_t n = keys[0].rows;
+    for (const auto& k : keys) {
+        if (k.rows != n) {
+            std::cerr << "Error: group-by key \"" << k.name << "\" has " << k.rows << " rows, expected " << n << "\n";
+            return false;
+        }
+        if (k.kind == ColumnKind::F64) {
+            std::cerr << "Error: group-by key \"" << k.name << "\" is floating point\n";
+            return false;
+        }
+    }
+    for (const auto& a : aggregates) {
+        if (a.op != AggOp::Count && a.rows != n) {
+            std::cerr << "Error: aggregate \"" << a.name << "\" has " << a.rows << " rows, expected " << n << "\n";
+            return false;
+        }
+    }
+
+    KeyLayout layout;
+    if (!planKeys(keys, layout)) return false;
+
+    // Aggregates over columns with nulls get a hidden Count of their
+    // non-null rows (the Avg divisor; zero means no value)
+    std::vector<Aggregate> work = aggregates;
+    std::vector<std::size_t> nonNull(aggregates.size(), SIZE_MAX);
+    for (std::size_t a = 0; a < aggregates.size(); ++a) {
+        const Aggregate& agg = aggregates[a];
+        if (agg.op == AggOp::Count || !agg.valid) continue;
+        nonNull[a] = work.size();
+        work.push_back(Aggregate{AggOp::Count, agg.name, agg.kind, agg.data, agg.rows, agg.valid});
+    }
+
+    ThreadPool& pool = ThreadPool::global();
+    const std::size_t A = work.size();
+    std::vector<WorkerState> workers(pool.size());
+
+    if (layout.dense) {
+        // Phase 1: every worker fills its own dense arrays
+        for (auto& w : workers) {
+            w.arena.counts.assign(layout.groups, 0);
+            w.arena.values.resize(layout.groups * A);
+            for (std::size_t g = 0; g < layout.groups; ++g)
+                for (std::size_t a = 0; a < A; ++a) w.arena.values[g * A + a] = identityOf(work[a].op);
+        }
+        pool.forEachMorsel(n, [&](const ThreadPool::Morsel& m, unsigned wi) {
+            Arena& arena = workers[wi].arena;
+            uint32_t idx[kChunkRows];
+            for (std::size_t c = m.begin; c < m.end; c += kChunkRows) {
+                const std::size_t len = std::min(kChunkRows, m.end - c);
+                std::fill(idx, idx + len, 0u);
+                for (std::size_t k = 0; k < keys.size(); ++k) {
+                    const uint32_t stride = static_cast<uint32_t>(layout.stride[k]);
+                    forChunk(keys[k].kind, keys[k].data, c, len,
+                             [&](std::size_t j, auto code) { idx[j] += static_cast<uint32_t>(code) * stride; });
+                }
+                accumulateChunk(work, c, len, idx, arena.counts.data(), arena.values.data());
+            }
+        });
+
+        // Phase 2: merge by group-id range, each range by one task
+        Arena merged = std::move(workers[0].arena);
+        pool.forEachMorsel(layout.groups, [&](const ThreadPool::Morsel& m, unsigned) {
+            for (std::size_t w = 1; w < workers.size(); ++w) {
+                const Arena& src = workers[w].arena;
+                for (std::size_t g = m.begin; g < m.end; ++g) {
+                    merged.counts[g] += src.counts[g];
+                    for (std::size_t a = 0; a < A; ++a)
+                        combine(work[a].op, merged.values[g * A + a], src.values[g * A + a]);
+                }
+            }
+        }, 4096);
+
+        for (std::size_t g = 0; g < layout.groups; ++g)
+            if (merged.counts[g] != 0)
+                emitGroup(keys, aggregates, nonNull, layout, g, merged.counts[g], merged.values.data() + g * A, out);
+        return true;
+    }
+
+    // Hash path. Phase 1: per-worker tables; each new group is also listed
+    // under its radix partition (top hash bits)
+    pool.forEachMorsel(n, [&](const ThreadPool::Morsel& m, unsigned wi) {
+        WorkerState& ws = workers[wi];
+        uint64_t packed[kChunkRows];
+        uint32_t idx[kChunkRows];
+        for (std::size_t c = m.begin; c < m.end; c += kChunkRows) {
+            const std::size_t len = std::min(kChunkRows, m.end - c);
+            std::fill(packed, packed + len, uint64_t(0));
+            for (std::size_t k = 0; k < keys.size(); ++k) {
+                const unsigned shift = layout.shift[k];
+                forChunk(keys[k].kind, keys[k].data, c, len,
+                         [&](std::size_t j, auto v) { packed[j] |= orderedBits(v) << shift; });
+                // Null rows all hold 0; the flag above the value makes them one group, sorted last
+                if (keys[k].valid) {
+                    const uint64_t flag = uint64_t(1) << (shift + layout.bits[k] - 1);
+                    for (std::size_t j = 0; j < len; ++j)
+                        if (!validAt(keys[k].valid, c + j)) packed[j] |= flag;
+                }
+            }
+            for (std::size_t j = 0; j < len; ++j) {
+                const uint64_t h = mixHash(packed[j]);
+                bool isNew;
+                idx[j] = ws.table.findOrAdd(packed[j], h, ws.arena, work, isNew);
+                if (isNew) ws.partitionSlots[h >> (64 - kPartitionBits)].push_back(idx[j]);
+            }
+            accumulateChunk(work, c, len, idx, ws.arena.counts.data(), ws.arena.values.data());
+        }
+    });
+
+    // Phase 2: each partition merges its groups from every worker on its own
+    std::vector<WorkerState> parts(kPartitions);
+    pool.forEachMorsel(kPartitions, [&](const ThreadPool::Morsel& m, unsigned) {
+        for (std::size_t p = m.begin; p < m.end; ++p) {
+            WorkerState& dst = parts[p];
+            for (const WorkerState& src : workers) {
+                for (uint32_t s : src.partitionSlots[p]) {
+                    const uint64_t key = src.arena.keys[s];
+                    bool isNew;
+                    const uint32_t d = dst.table.findOrAdd(key, mixHash(key), dst.arena, work, isNew);
+                    dst.arena.counts[d] += src.arena.counts[s];
+                    for (std::size_t a = 0; a < A; ++a)
+                        combine(work[a].op, dst.arena.values[d * A + a], src.arena.values[s * A + a]);
+                }
+            }
+        }
+    }, 1);
+
+    // Emit in key order
+    std::vector<std::pair<uint64_t, std::pair<uint32_t, uint32_t>>> order;
+    for (uint32_t p = 0; p < kPartitions; ++p)
+        for (uint32_t s = 0; s < parts[p].arena.keys.size(); ++s)
+            order.push_back({parts[p].arena.keys[s], {p, s}});
+    std::sort(order.begin(), order.end());
+    for (const auto& o : order) {
+        const Arena& arena = parts[o.second.first].arena;
+        const uint32_t s = o.second.second;
+        emitGroup(keys, aggregates, nonNull, layout, o.first, arena.counts[s], arena.values.data() + s * A, out);
+    }
+    return true;
+}
+
+std::string GroupByResult::keyLabel(std::size_t group, std::size_t key) const {
+    if (keyIsNull(group, key)) return "(null)";
+    const uint64_t v = keyValue(group, key);
+    const GroupKey& k = keys[key];
+    if (k.dictionary) {
+        const std::string& s = (*k.dictionary)[v];
+        return s.empty() ? "(empty)" : s;
+    }
+    return isSigned(k.kind) ? std::to_string(static_cast<int64_t>(v)) : std::to_string(v);
+}
+
+void printGroupBy(const GroupByResult& result, std::size_t limit) {
+    const std::size_t k = std::min(limit, result.size());
+    std::cout << "  Groups - (" << k << "/" << result.size() << "):\n";
+    for (std::size_t g = 0; g < k; ++g) {
+        std::cout << "    [" << g << "]";
+        for (std::size_t i = 0; i < result.keys.size(); ++i)
+            std::cout << " " << result.keys[i].name << "=" << result.keyLabel(g, i);
+        for (std::size_t a = 0; a < result.aggregates.size(); ++a) {
+            const Aggregate& agg = result.aggregates[a];
+            std::cout << " " << agg.name << "=";
+            // Integer columns keep integer output except for averages
+            if (std::isnan(result.value(g, a)))
+                std::cout << "(null)";
+            else if (agg.op == AggOp::Count || (agg.kind != ColumnKind::F64 && agg.op != AggOp::Avg))
+                std::cout << static_cast<long long>(result.value(g, a));
+            else
+                std::cout << result.value(g, a);
+        }
+        std::cout << "\n";
+    }
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "DictColumn.h"
+#include "NullableColumn.h"
+
+// ---------------------------------------------------------------------------
+// GroupBy
+//   Parallel GROUP BY over OoA columns for ad-hoc rollups:
+//
+//     GroupByResult r;
+//     groupBy({groupKey("borough", data.boroughUpper), groupKey("status", data.status)},
+//             {countRows(), aggregate(AggOp::Avg, "lat", data.latitude)}, r);
+//
+//   Keys are dictionary columns (grouped by code) or integer columns. When
+//   every key is dictionary-encoded and the product of the dictionary sizes
+//   is small, each pool worker aggregates into a dense array indexed by the
+//   combined code. Otherwise the keys are packed into 64 bits and each
+//   worker uses open-addressing hash tables, split into radix partitions by
+//   hash. Either way the merge is parallel: each key range (dense) or
+//   partition (hash) is merged across workers by one task.
+//
+//   Rows are processed in small chunks, one column at a time, so the inner
+//   loops never switch on column type or aggregate kind.
+//
+//   NullableColumns with nulls bring their validity bitmap: a null key forms
+//   its own group (sorted last, labelled "(null)"), and Count / Sum / Min /
+//   Max / Avg over the column skip null values (Count counts the non-null
+//   rows; Avg divides by that count; a group with no non-null value gets
+//   NaN for the others). countRows() counts every row. Columns without
+//   nulls take the plain path.
+//   Groups come out ordered by key (dictionary code / integer value, first
+//   key most significant).
+// ---------------------------------------------------------------------------
+
+enum class AggOp { Count, Sum, Min, Max, Avg };
+
+// Physical type of a column the engine reads
+enum class ColumnKind : uint8_t { U8, U16, U32, U64, I16, I32, F64 };
+
+template <typename T> constexpr ColumnKind columnKindOf();
+template <> constexpr ColumnKind columnKindOf<uint8_t>()  { return ColumnKind::U8; }
+template <> constexpr ColumnKind columnKindOf<uint16_t>() { return ColumnKind::U16; }
+template <> constexpr ColumnKind columnKindOf<uint32_t>() { return ColumnKind::U32; }
+template <> constexpr ColumnKind columnKindOf<uint64_t>() { return ColumnKind::U64; }
+template <> constexpr ColumnKind columnKindOf<int16_t>()  { return ColumnKind::I16; }
+template <> constexpr ColumnKind columnKindOf<int32_t>()  { return ColumnKind::I32; }
+template <> constexpr ColumnKind columnKindOf<double>()   { return ColumnKind::F64; }
+
+struct GroupKey {
+    std::string name;
+    ColumnKind  kind = ColumnKind::U8;
+    const void* data = nullptr;
+    std::size_t rows = 0;
+    const std::vector<std::string>* dictionary = nullptr;   // set for dictionary columns
+    const uint64_t* valid = nullptr;                         // validity bitmap, if the key has nulls
+};
+
+struct Aggregate {
+    AggOp       op = AggOp::Count;
+    std::string name;
+    ColumnKind  kind = ColumnKind::F64;
+    const void* data = nullptr;                              // unused for Count
+    std::size_t rows = 0;
+    const uint64_t* valid = nullptr;                         // validity bitmap, if the column has nulls
+};
+
+template <typename Code>
+GroupKey groupKey(const char* name, const DictColumn<Code>& col) {
+    return GroupKey{name, columnKindOf<Code>(), col.codes().data(), col.size(), &col.dictionary()};
+}
+
+template <typename T>
+GroupKey groupKey(const char* name, const std::vector<T>& col) {
+    static_assert(std::is_integral<T>::value, "group keys must be integer or dictionary columns");
+    return GroupKey{name, columnKindOf<T>(), col.data(), col.size(), nullptr};
+}
+
+template <typename T>
+GroupKey groupKey(const char* name, const NullableColumn<T>& col) {
+    static_assert(std::is_integral<T>::value, "group keys must be integer or dictionary columns");
+    return GroupKey{name, columnKindOf<T>(), col.data(), col.size(), nullptr,
+                    col.hasNulls() ? col.validity() : nullptr};
+}
+
+inline Aggregate countRows(const char* name = "count") {
+    return Aggregate{AggOp::Count, name, ColumnKind::F64, nullptr, 0};
+}
+
+template <typename T>
+Aggregate aggregate(AggOp op, const char* name, const std::vector<T>& col) {
+    return Aggregate{op, name, columnKindOf<T>(), col.data(), col.size()};
+}
+
+template <typename T>
+Aggregate aggregate(AggOp op, const char* name, const NullableColumn<T>& col) {
+    return Aggregate{op, name, columnKindOf<T>(), col.data(), col.size(),
+                     col.hasNulls() ? col.validity() : nullptr};
+}
+
+struct GroupByResult {
+    std::vector<GroupKey>  keys;
+    std::vector<Aggregate> aggregates;
+
+    std::vector<uint64_t> keyValues;   // size() x keys: dictionary code or integer value (as int64 bits)
+    std::vector<uint8_t>  keyNulls;    // size() x keys: 1 where the key is null (its value is 0)
+    std::vector<uint64_t> counts;      // rows per group
+    std::vector<double>   values;      // size() x aggregates, final (Avg divided, Count = rows)
+
+    std::size_t size() const { return counts.size(); }
+    double value(std::size_t group, std::size_t agg) const { return values[group * aggregates.size() + agg]; }
+    uint64_t keyValue(std::size_t group, std::size_t key) const { return keyValues[group * keys.size() + key]; }
+    bool keyIsNull(std::size_t group, std::size_t key) const { return keyNulls[group * keys.size() + key] != 0; }
+
+    // Decoded key: the dictionary string, the integer as text, or "(null)"
+    std::string keyLabel(std::size_t group, std::size_t key) const;
+};
+
+// Groups all rows by `keys` and computes `aggregates` per group. Returns
+// false (with a message on std::cerr) if the columns don't line up or the
+// keys need more than 64 bits together.
+bool groupBy(const std::vector<GroupKey>& keys, const std::vector<Aggregate>& aggregates,
+             GroupByResult& out);
+
+// Prints the first `limit` groups as a table
+void printGroupBy(const GroupByResult& result, std::size_t limit);
@@ -0,0 +1,116 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "../common/MemStats.h"
+
+// Fixed-width column (dates, zip, coordinates, ...) with a validity bitmap:
+// bit i of validity() is 1 when row i holds a value and 0 when its field was
+// empty or did not parse. Words cover 64 rows, like RowBitmap, and bits past
+// size() are 0.
+//
+// A null row stores T{} (0) in the value array, so the values stay one
+// dense array and kernels that need no null handling run on it unchanged:
+// a SUM over values() is already the sum of the non-null rows, and a range
+// that excludes 0 never matches a null. COUNT / AVG take the non-null count
+// from the bitmap (popcount), and MIN / MAX or predicates that 0 could
+// satisfy AND with the validity words. A column with nullCount() == 0 lets
+// callers skip the bitmap entirely.
+template <typename T>
+class NullableColumn {
+   static_assert(std::is_arithmetic<T>::value, "nullable columns hold numbers");
+
+public:
+   using value_type = T;
+
+   std::size_t size() const { return values_.size(); }
+   bool empty() const { return values_.empty(); }
+   void reserve(std::size_t rows) {
+      values_.reserve(rows);
+      valid_.reserve(wordsFor(rows));
+   }
+
+   T operator[](std::size_t i) const { return values_[i]; }
+   const T* data() const { return values_.data(); }
+   const std::vector<T>& values() const { return values_; }
+
+   bool isValid(std::size_t i) const { return (valid_[i / 64] >> (i % 64)) & 1; }
+   const uint64_t* validity() const { return valid_.data(); }
+   std::size_t validityWords() const { return valid_.size(); }
+   std::size_t nullCount() const { return nulls_; }
+   bool hasNulls() const { return nulls_ != 0; }
+
+   std::size_t memoryBytes() const { return allocatedBytes(values_) + allocatedBytes(valid_); }
+
+   void push_back(T v) { push(v, true); }
+   void push_null() { push(T{}, false); }
+
+   void clear() {
+      values_.clear();
+      valid_.clear();
+      nulls_ = 0;
+   }
+
+   // Appends the first `count` rows of another column; its validity bits
+   // are shifted into place a word at a time
+   void append(const NullableColumn& other, std::size_t count) {
+      const std::size_t offset = values_.size() % 64;
+      values_.insert(values_.end(), other.values_.begin(),
+                     other.values_.begin() + static_cast<std::ptrdiff_t>(count));
+      for (std::size_t w = 0; w < wordsFor(count); ++w) {
+         uint64_t bits = other.valid_[w];
+         if (count - w * 64 < 64) bits &= (uint64_t(1) << (count - w * 64)) - 1;
+         if (offset == 0) {
+            valid_.push_back(bits);
+         } else {
+            valid_.back() |= bits << offset;
+            valid_.push_back(bits >> (64 - offset));
+         }
+         nulls_ += static_cast<std::size_t>(__builtin_popcountll(~bits)) -
+                   (count - w * 64 < 64 ? 64 - (count - w * 64) : 0);
+      }
+      valid_.resize(wordsFor(values_.size()));
+   }
+
+   // Bulk restore (snapshot load). `validity` must hold wordsFor(rows)
+   // words with no bits set past the last row, and null rows must be 0.
+   bool assign(std::vector<T> values, std::vector<uint64_t> validity) {
+      const std::size_t rows = values.size();
+      if (validity.size() != wordsFor(rows)) return false;
+      if (rows % 64 != 0 && (validity.back() >> (rows % 64)) != 0) return false;
+      std::size_t valid = 0;
+      for (uint64_t w : validity) valid += static_cast<std::size_t>(__builtin_popcountll(w));
+      values_ = std::move(values);
+      valid_ = std::move(validity);
+      nulls_ = rows - valid;
+      return true;
+   }
+
+   static std::size_t wordsFor(std::size_t rows) { return (rows + 63) / 64; }
+
+private:
+   void push(T v, bool valid) {
+      const std::size_t i = values_.size();
+      if (i % 64 == 0) valid_.push_back(0);
+      values_.push_back(v);
+      valid_.back() |= uint64_t(valid) << (i % 64);
+      nulls_ += !valid;
+   }
+
+   std::vector<T> values_;
+   std::vector<uint64_t> valid_;   // wordsFor(size()) words, 1 = valid
+   std::size_t nulls_ = 0;
+};
+
+// Validity word w of a column, all ones when the column has no bitmap
+// (validity pointer null): lets kernels AND optional bitmaps uniformly
+inline uint64_t validWord(const uint64_t* validity, std::size_t w) {
+   return validity ? validity[w] : ~uint64_t(0);
+}
+
+template <typename Col>
+struct isNullableColumn : std::false_type {};
+template <typename T>
+struct isNullableColumn<NullableColumn<T>> : std::true_type {};
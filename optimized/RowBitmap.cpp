@@ -0,0 +1,81 @@
+#include "RowBitmap.h"
+
+#include <algorithm>
+
+// The word loops are simple enough for the compiler to vectorize; the pool
+// splits them into 64K-row morsels (1024 words), so small bitmaps run inline.
+
+std::size_t RowBitmap::count() const {
+    const std::size_t W = words_.size();
+    if (W == 0) return 0;
+    const uint64_t* w = words_.data();
+    std::vector<std::size_t> partial(ThreadPool::morselCount(W, kMorselWords), 0);
+    ThreadPool::global().forEachMorsel(W, [&](const ThreadPool::Morsel& m, unsigned) {
+        std::size_t n = 0;
+        for (std::size_t i = m.begin; i < m.end; ++i)
+            n += static_cast<std::size_t>(__builtin_popcountll(w[i]));
+        partial[m.index] = n;
+    }, kMorselWords);
+    std::size_t total = 0;
+    for (std::size_t n : partial) total += n;
+    return total;
+}
+
+// Words the other bitmap lacks count as all-zero
+RowBitmap& RowBitmap::operator&=(const RowBitmap& other) {
+    const std::size_t common = std::min(words_.size(), other.words_.size());
+    uint64_t* a = words_.data();
+    const uint64_t* b = other.words_.data();
+    ThreadPool::global().forEachMorsel(words_.size(), [&](const ThreadPool::Morsel& m, unsigned) {
+        for (std::size_t i = m.begin; i < m.end; ++i)
+            a[i] = i < common ? (a[i] & b[i]) : 0;
+    }, kMorselWords);
+    return *this;
+}
+
+RowBitmap& RowBitmap::operator|=(const RowBitmap& other) {
+    const std::size_t W = std::min(words_.size(), other.words_.size());
+    uint64_t* a = words_.data();
+    const uint64_t* b = other.words_.data();
+    ThreadPool::global().forEachMorsel(W, [&](const ThreadPool::Morsel& m, unsigned) {
+        for (std::size_t i = m.begin; i < m.end; ++i)
+            a[i] |= b[i];
+    }, kMorselWords);
+    // keep bits past size() clear if other covered more rows
+    if (rows_ % 64 != 0 && !words_.empty())
+        words_.back() &= (uint64_t(1) << (rows_ % 64)) - 1;
+    return *this;
+}
+
+RowBitmap& RowBitmap::andNot(const RowBitmap& other) {
+    const std::size_t W = std::min(words_.size(), other.words_.size());
+    uint64_t* a = words_.data();
+    const uint64_t* b = other.words_.data();
+    ThreadPool::global().forEachMorsel(W, [&](const ThreadPool::Morsel& m, unsigned) {
+        for (std::size_t i = m.begin; i < m.end; ++i)
+            a[i] &= ~b[i];
+    }, kMorselWords);
+    return *this;
+}
+
+RowBitmap& RowBitmap::andWords(const uint64_t* words) {
+    uint64_t* a = words_.data();
+    ThreadPool::global().forEachMorsel(words_.size(), [&](const ThreadPool::Morsel& m, unsigned) {
+        for (std::size_t i = m.begin; i < m.end; ++i)
+            a[i] &= words[i];
+    }, kMorselWords);
+    return *this;
+}
+
+// The pool's ordered select over rows: each morsel expands its own
+// (whole) words into the worker's scratch
+std::vector<std::size_t> RowBitmap::toIndices() const {
+    const uint64_t* words = words_.data();
+    return ThreadPool::global().select(rows_, [&](std::size_t begin, std::size_t end, std::size_t* out) {
+        std::size_t n = 0;
+        for (std::size_t w = begin / 64; w < (end + 63) / 64; ++w)
+            for (uint64_t bits = words[w]; bits != 0; bits &= bits - 1)
+                out[n++] = w * 64 + static_cast<std::size_t>(__builtin_ctzll(bits));
+        return n;
+    });
+}
@@ -0,0 +1,252 @@
+#include "SelectKernels.h"
+#include "../common/CpuFeatures.h"
+
+#include <array>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SELECT_HAVE_X86_KERNELS 1
+#endif
+
+// ---------------------------------------------------------------------------
+// Range select / mask kernels
+//   Select kernels return the number of ids written; mask kernels fill one
+//   64-bit word per 64 rows. The tail (< one vector or word) always goes
+//   through the scalar loop.
+// ---------------------------------------------------------------------------
+
+// Branch-free: always store, advance only on a match
+static std::size_t selectRangeScalar(const uint32_t* keys, std::size_t begin, std::size_t end,
+                                     uint32_t lo, uint32_t hi, std::size_t* out) {
+    std::size_t n = 0;
+    const uint32_t width = hi - lo;
+    for (std::size_t i = begin; i < end; ++i) {
+        out[n] = i;
+        n += static_cast<uint32_t>(keys[i] - lo) <= width;
+    }
+    return n;
+}
+
+static void maskRangeScalar(const uint32_t* keys, std::size_t begin, std::size_t end,
+                            uint32_t lo, uint32_t hi, uint64_t* words) {
+    const uint32_t width = hi - lo;
+    for (std::size_t base = begin; base < end; base += 64) {
+        const std::size_t stop = end - base < 64 ? end - base : 64;
+        uint64_t w = 0;
+        for (std::size_t b = 0; b < stop; ++b)
+            w |= uint64_t(static_cast<uint32_t>(keys[base + b] - lo) <= width) << b;
+        words[base / 64] = w;
+    }
+}
+
+#ifdef SELECT_HAVE_X86_KERNELS
+static_assert(sizeof(std::size_t) == 8, "vector kernels emit 64-bit row ids");
+
+// lo <= k <= hi for unsigned lanes: clamp(k) == k
+__attribute__((target("sse4.2")))
+static std::size_t selectRangeSse42(const uint32_t* keys, std::size_t begin, std::size_t end,
+                                    uint32_t lo, uint32_t hi, std::size_t* out) {
+    const __m128i vlo = _mm_set1_epi32(static_cast<int>(lo));
+    const __m128i vhi = _mm_set1_epi32(static_cast<int>(hi));
+    std::size_t n = 0, i = begin;
+    for (; i + 4 <= end; i += 4) {
+        const __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+        const __m128i in = _mm_cmpeq_epi32(_mm_min_epu32(_mm_max_epu32(k, vlo), vhi), k);
+        const unsigned m = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(in)));
+        out[n] = i;     n += m & 1;
+        out[n] = i + 1; n += (m >> 1) & 1;
+        out[n] = i + 2; n += (m >> 2) & 1;
+        out[n] = i + 3; n += (m >> 3) & 1;
+    }
+    return n + selectRangeScalar(keys, i, end, lo, hi, out + n);
+}
+
+__attribute__((target("sse4.2")))
+static void maskRangeSse42(const uint32_t* keys, std::size_t begin, std::size_t end,
+                           uint32_t lo, uint32_t hi, uint64_t* words) {
+    const __m128i vlo = _mm_set1_epi32(static_cast<int>(lo));
+    const __m128i vhi = _mm_set1_epi32(static_cast<int>(hi));
+    std::size_t base = begin;
+    for (; base + 64 <= end; base += 64) {
+        uint64_t w = 0;
+        for (unsigned b = 0; b < 64; b += 4) {
+            const __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + base + b));
+            const __m128i in = _mm_cmpeq_epi32(_mm_min_epu32(_mm_max_epu32(k, vlo), vhi), k);
+            w |= uint64_t(static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(in)))) << b;
+        }
+        words[base / 64] = w;
+    }
+    maskRangeScalar(keys, base, end, lo, hi, words);
+}
+
+// For each 4-bit match mask: 32-bit lane permutation that packs the
+// selected 64-bit ids to the front of a __m256i
+static const std::array<std::array<uint32_t, 8>, 16> kCompress4x64 = [] {
+    std::array<std::array<uint32_t, 8>, 16> t{};
+    for (unsigned m = 0; m < 16; ++m) {
+        unsigned slot = 0;
+        for (unsigned lane = 0; lane < 4; ++lane) {
+            if (!(m & (1u << lane))) continue;
+            t[m][2 * slot] = 2 * lane;
+            t[m][2 * slot + 1] = 2 * lane + 1;
+            ++slot;
+        }
+    }
+    return t;
+}();
+
+__attribute__((target("avx2,popcnt")))
+static std::size_t selectRangeAvx2(const uint32_t* keys, std::size_t begin, std::size_t end,
+                                   uint32_t lo, uint32_t hi, std::size_t* out) {
+    const __m256i vlo = _mm256_set1_epi32(static_cast<int>(lo));
+    const __m256i vhi = _mm256_set1_epi32(static_cast<int>(hi));
+    const __m256i step = _mm256_set1_epi64x(8);
+    __m256i idxLo = _mm256_setr_epi64x(begin, begin + 1, begin + 2, begin + 3);
+    __m256i idxHi = _mm256_setr_epi64x(begin + 4, begin + 5, begin + 6, begin + 7);
+
+    std::size_t n = 0, i = begin;
+    for (; i + 8 <= end; i += 8) {
+        const __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+        const __m256i in = _mm256_cmpeq_epi32(_mm256_min_epu32(_mm256_max_epu32(k, vlo), vhi), k);
+        const unsigned m = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(in)));
+
+        // Full-vector stores stay inside `out`: n <= i - begin on entry
+        const unsigned m0 = m & 15, m1 = m >> 4;
+        const __m256i p0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(kCompress4x64[m0].data()));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + n), _mm256_permutevar8x32_epi32(idxLo, p0));
+        n += static_cast<std::size_t>(_mm_popcnt_u32(m0));
+        const __m256i p1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(kCompress4x64[m1].data()));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + n), _mm256_permutevar8x32_epi32(idxHi, p1));
+        n += static_cast<std::size_t>(_mm_popcnt_u32(m1));
+
+        idxLo = _mm256_add_epi64(idxLo, step);
+        idxHi = _mm256_add_epi64(idxHi, step);
+    }
+    return n + selectRangeScalar(keys, i, end, lo, hi, out + n);
+}
+
+__attribute__((target("avx2")))
+static void maskRangeAvx2(const uint32_t* keys, std::size_t begin, std::size_t end,
+                          uint32_t lo, uint32_t hi, uint64_t* words) {
+    const __m256i vlo = _mm256_set1_epi32(static_cast<int>(lo));
+    const __m256i vhi = _mm256_set1_epi32(static_cast<int>(hi));
+    std::size_t base = begin;
+    for (; base + 64 <= end; base += 64) {
+        uint64_t w = 0;
+        for (unsigned b = 0; b < 64; b += 8) {
+            const __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + base + b));
+            const __m256i in = _mm256_cmpeq_epi32(_mm256_min_epu32(_mm256_max_epu32(k, vlo), vhi), k);
+            w |= uint64_t(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(in)))) << b;
+        }
+        words[base / 64] = w;
+    }
+    maskRangeScalar(keys, base, end, lo, hi, words);
+}
+
+// Compress into a register and store the whole vector: a masked
+// compress-store to memory is microcoded and much slower on some cores
+__attribute__((target("avx512f,popcnt")))
+static std::size_t selectRangeAvx512(const uint32_t* keys, std::size_t begin, std::size_t end,
+                                     uint32_t lo, uint32_t hi, std::size_t* out) {
+    const __m512i vlo = _mm512_set1_epi32(static_cast<int>(lo));
+    const __m512i vhi = _mm512_set1_epi32(static_cast<int>(hi));
+    const __m512i step = _mm512_set1_epi64(16);
+    __m512i idxLo = _mm512_add_epi64(_mm512_set1_epi64(static_cast<long long>(begin)),
+                                     _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7));
+    __m512i idxHi = _mm512_add_epi64(idxLo, _mm512_set1_epi64(8));
+
+    std::size_t n = 0, i = begin;
+    for (; i + 16 <= end; i += 16) {
+        const __m512i k = _mm512_loadu_si512(keys + i);
+        const __mmask16 m = _mm512_cmpge_epu32_mask(k, vlo) & _mm512_cmple_epu32_mask(k, vhi);
+
+        const __mmask8 m0 = static_cast<__mmask8>(m), m1 = static_cast<__mmask8>(m >> 8);
+        _mm512_storeu_si512(out + n, _mm512_maskz_compress_epi64(m0, idxLo));
+        n += static_cast<std::size_t>(_mm_popcnt_u32(m0));
+        _mm512_storeu_si512(out + n, _mm512_maskz_compress_epi64(m1, idxHi));
+        n += static_cast<std::size_t>(_mm_popcnt_u32(m1));
+
+        idxLo = _mm512_add_epi64(idxLo, step);
+        idxHi = _mm512_add_epi64(idxHi, step);
+    }
+    return n + selectRangeScalar(keys, i, end, lo, hi, out + n);
+}
+
+__attribute__((target("avx512f")))
+static void maskRangeAvx512(const uint32_t* keys, std::size_t begin, std::size_t end,
+                            uint32_t lo, uint32_t hi, uint64_t* words) {
+    const __m512i vlo = _mm512_set1_epi32(static_cast<int>(lo));
+    const __m512i vhi = _mm512_set1_epi32(static_cast<int>(hi));
+    std::size_t base = begin;
+    for (; base + 64 <= end; base += 64) {
+        uint64_t w = 0;
+        for (unsigned b = 0; b < 64; b += 16) {
+            const __m512i k = _mm512_loadu_si512(keys + base + b);
+            const __mmask16 m = _mm512_cmpge_epu32_mask(k, vlo) & _mm512_cmple_epu32_mask(k, vhi);
+            w |= uint64_t(m) << b;
+        }
+        words[base / 64] = w;
+    }
+    maskRangeScalar(keys, base, end, lo, hi, words);
+}
+#endif
+
+using RangeSelectFn = std::size_t (*)(const uint32_t*, std::size_t, std::size_t,
+                                      uint32_t, uint32_t, std::size_t*);
+
+static RangeSelectFn activeRangeSelect() {
+    static const RangeSelectFn fn = [] {
+#ifdef SELECT_HAVE_X86_KERNELS
+        switch (simdLevel()) {
+            case SimdLevel::AVX512: return selectRangeAvx512;
+            case SimdLevel::AVX2:   return selectRangeAvx2;
+            case SimdLevel::SSE42:  return selectRangeSse42;
+            default: break;
+        }
+#endif
+        return selectRangeScalar;
+    }();
+    return fn;
+}
+
+using RangeMaskFn = void (*)(const uint32_t*, std::size_t, std::size_t,
+                             uint32_t, uint32_t, uint64_t*);
+
+static RangeMaskFn activeRangeMask() {
+    static const RangeMaskFn fn = [] {
+#ifdef SELECT_HAVE_X86_KERNELS
+        switch (simdLevel()) {
+            case SimdLevel::AVX512: return maskRangeAvx512;
+            case SimdLevel::AVX2:   return maskRangeAvx2;
+            case SimdLevel::SSE42:  return maskRangeSse42;
+            default: break;
+        }
+#endif
+        return maskRangeScalar;
+    }();
+    return fn;
+}
+
+std::size_t selectInRangeU32(const uint32_t* keys, std::size_t begin, std::size_t end,
+                             uint32_t lo, uint32_t hi, std::size_t* out) {
+    if (begin >= end || lo > hi) return 0;
+    return activeRangeSelect()(keys, begin, end, lo, hi, out);
+}
+
+void maskInRangeU32(const uint32_t* keys, std::size_t begin, std::size_t end,
+                    uint32_t lo, uint32_t hi, uint64_t* words) {
+    if (begin >= end) return;
+    if (lo > hi) {
+        for (std::size_t w = begin / 64; w < (end + 63) / 64; ++w) words[w] = 0;
+        return;
+    }
+    activeRangeMask()(keys, begin, end, lo, hi, words);
+}
+
+const char* selectKernelName() {
+#ifdef SELECT_HAVE_X86_KERNELS
+    return simdLevelName(simdLevel());
+#else
+    return simdLevelName(SimdLevel::Scalar);
+#endif
+}
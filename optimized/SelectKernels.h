@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// ---------------------------------------------------------------------------
+// Selection kernels
+//   A selection vector is the ascending list of row ids that pass a filter.
+//   Kernels compare 4/8/16 keys per instruction (SSE4.2/AVX2/AVX-512, picked
+//   at runtime through common/CpuFeatures) and compress the matching row ids
+//   straight into the output, with no intermediate per-row flag array.
+//   Queries run them per morsel through ThreadPool::select.
+// ---------------------------------------------------------------------------
+
+// Writes every row id i in [begin, end) with lo <= keys[i] <= hi to `out`,
+// in order, and returns how many were written. `out` must have room for
+// (end - begin) ids: kernels store full vectors past the last match.
+std::size_t selectInRangeU32(const uint32_t* keys, std::size_t begin, std::size_t end,
+                             uint32_t lo, uint32_t hi, std::size_t* out);
+
+// Bitmap form of the same predicate: sets bit (i % 64) of words[i / 64]
+// for every row i in [begin, end) with lo <= keys[i] <= hi. `begin` must be
+// a multiple of 64; whole words are overwritten (bits past `end` are 0).
+void maskInRangeU32(const uint32_t* keys, std::size_t begin, std::size_t end,
+                    uint32_t lo, uint32_t hi, uint64_t* words);
+
+// Name of the kernel selectInRangeU32 / maskInRangeU32 dispatch to
+const char* selectKernelName();
@@ -0,0 +1,127 @@
+// Correctness check: selectInRangeU32 / maskInRangeU32 against a scalar
+// reference, over random keys, bounds and [begin, end) offsets. Buffers are
+// sized exactly to each call's contract, so under ASan a vector store or
+// load past the allowed range is reported. The kernel is picked once per
+// process; run once per NYC311_SIMD level.
+//
+// Build:  g++ -std=c++17 -O1 -g -fsanitize=address,undefined -o select_check SelectKernelsCheck.cpp SelectKernels.cpp ../common/CpuFeatures.cpp
+// Run:    for l in scalar sse42 avx2 avx512; do NYC311_SIMD=$l ./select_check [cases]; done
+#include "SelectKernels.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+static bool inRange(uint32_t k, uint32_t lo, uint32_t hi) { return lo <= k && k <= hi; }
+
+// Keys from a small domain (dense matches, ties, lo == hi) or near the ends
+// of uint32 (unsigned compare edges)
+static std::vector<uint32_t> makeKeys(std::mt19937& rng, std::size_t n) {
+    std::vector<uint32_t> keys(n);
+    const uint32_t maxKey = std::numeric_limits<uint32_t>::max();
+    switch (rng() % 3) {
+        case 0:
+            for (auto& k : keys) k = rng() % 64;
+            break;
+        case 1:
+            for (auto& k : keys) k = rng() % 2 ? rng() % 8 : maxKey - rng() % 8;
+            break;
+        default:
+            for (auto& k : keys) k = static_cast<uint32_t>(rng());
+            break;
+    }
+    return keys;
+}
+
+static void pickBounds(std::mt19937& rng, const std::vector<uint32_t>& keys, uint32_t& lo, uint32_t& hi) {
+    const uint32_t maxKey = std::numeric_limits<uint32_t>::max();
+    switch (rng() % 5) {
+        case 0: lo = 0; hi = maxKey; break;                       // everything
+        case 1: lo = static_cast<uint32_t>(rng()); hi = lo; break; // usually nothing
+        default:
+            // Bounds taken from the keys, possibly reversed (lo > hi: empty)
+            lo = keys.empty() ? 0 : keys[rng() % keys.size()];
+            hi = keys.empty() ? 0 : keys[rng() % keys.size()];
+            if (rng() % 4 != 0 && lo > hi) std::swap(lo, hi);
+            break;
+    }
+}
+
+static bool checkSelect(const std::vector<uint32_t>& all, std::size_t begin, std::size_t end,
+                        uint32_t lo, uint32_t hi) {
+    // Keys end exactly at `end`, output holds exactly (end - begin) ids
+    std::vector<uint32_t> keys(all.begin(), all.begin() + static_cast<std::ptrdiff_t>(end));
+    std::vector<std::size_t> out(end - begin);
+    const std::size_t n = selectInRangeU32(keys.data(), begin, end, lo, hi, out.data());
+
+    std::size_t expected = 0;
+    for (std::size_t i = begin; i < end; ++i) {
+        if (!inRange(keys[i], lo, hi)) continue;
+        if (expected >= n || out[expected] != i) {
+            std::cerr << "select: row " << i << " missing or out of order (begin=" << begin
+                      << " end=" << end << " lo=" << lo << " hi=" << hi << ")\n";
+            return false;
+        }
+        ++expected;
+    }
+    if (n != expected) {
+        std::cerr << "select: returned " << n << " ids, expected " << expected << " (begin=" << begin
+                  << " end=" << end << " lo=" << lo << " hi=" << hi << ")\n";
+        return false;
+    }
+    return true;
+}
+
+static bool checkMask(const std::vector<uint32_t>& all, std::size_t begin, std::size_t end,
+                      uint32_t lo, uint32_t hi) {
+    const uint64_t sentinel = 0x5a5a5a5a5a5a5a5aull;
+    std::vector<uint32_t> keys(all.begin(), all.begin() + static_cast<std::ptrdiff_t>(end));
+    std::vector<uint64_t> words((end + 63) / 64, sentinel);
+    maskInRangeU32(keys.data(), begin, end, lo, hi, words.data());
+
+    for (std::size_t w = 0; w < begin / 64; ++w) {
+        if (words[w] != sentinel) {
+            std::cerr << "mask: word " << w << " before begin=" << begin << " was written\n";
+            return false;
+        }
+    }
+    for (std::size_t w = begin / 64; w < words.size(); ++w) {
+        uint64_t expected = 0;
+        for (std::size_t b = 0; b < 64 && w * 64 + b < end; ++b)
+            expected |= uint64_t(inRange(keys[w * 64 + b], lo, hi)) << b;
+        if (words[w] != expected) {
+            std::cerr << "mask: word " << w << " is " << std::hex << words[w] << ", expected " << expected
+                      << std::dec << " (begin=" << begin << " end=" << end << " lo=" << lo
+                      << " hi=" << hi << ")\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    const std::size_t cases = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 20000;
+    std::mt19937 rng(311);
+
+    std::size_t failures = 0;
+    for (std::size_t c = 0; c < cases && failures < 10; ++c) {
+        // Mostly short ranges (every tail length), sometimes several vectors' worth
+        const std::size_t n = rng() % 8 == 0 ? 1000 + rng() % 5000 : rng() % 300;
+        const std::vector<uint32_t> keys = makeKeys(rng, n);
+        uint32_t lo, hi;
+        pickBounds(rng, keys, lo, hi);
+
+        std::size_t begin = n ? rng() % (n + 1) : 0;
+        std::size_t end = begin + (n - begin ? rng() % (n - begin + 1) : 0);
+        if (!checkSelect(keys, begin, end, lo, hi)) ++failures;
+
+        begin -= begin % 64;   // mask kernels take word-aligned starts
+        if (!checkMask(keys, begin, end, lo, hi)) ++failures;
+    }
+
+    std::cout << "kernel=" << selectKernelName() << " cases=" << cases << " failures=" << failures << "\n";
+    return failures == 0 ? 0 : 1;
+}
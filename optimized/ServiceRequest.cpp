@@ -1,126 +1,210 @@
 #include "ServiceRequest.h"
+#include "Snapshot.h"
+#include "../common/CsvRecords.h"
+#include "../common/DateParse.h"
+#include "../common/MappedFile.h"
+#include "../common/BoundedQueue.h"
+#include "../common/ThreadPool.h"
 #include <vector>
 #include <string>
+#include <string_view>
+#include <charconv>
+#include <cstring>
 #include <fstream>
 #include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <thread>
+#include <type_traits>
 #include <cctype>
 #include <iostream>
-#include <cstdio>
 #include <cstdlib>
+#include <cstdio>
 
 
-// Helper functions for parsing fields (minimal, can be expanded as needed)
-static uint32_t parseZip(const std::string& s) {
-   if (s.empty()) return 0;
-   char* end = nullptr;
-   unsigned long v = std::strtoul(s.c_str(), &end, 10);
-   if (end == s.c_str()) return 0;
-   return static_cast<uint32_t>(v);
+// Helper functions for parsing fields (minimal, can be expanded as needed).
+// They take string_view so the mapped loader can parse straight from the file.
+template <typename T>
+static bool parseInteger(std::string_view s, T& out) {
+   while (!s.empty() && s.front() == ' ') s.remove_prefix(1);
+   if (!s.empty() && s.front() == '+') s.remove_prefix(1);
+   auto r = std::from_chars(s.data(), s.data() + s.size(), out);
+   return r.ec == std::errc();
 }
-static int16_t parseInt16(const std::string& s) {
-   if (s.empty()) return -1;
-   char* end = nullptr;
-   long v = std::strtol(s.c_str(), &end, 10);
-   if (end == s.c_str()) return -1;
-   return static_cast<int16_t>(v);
+static uint64_t parseU64(std::string_view s) {
+   uint64_t v = 0;
+   return parseInteger(s, v) ? v : 0;
 }
-static uint64_t parseU64(const std::string& s) {
-   if (s.empty()) return 0;
+static bool parseDouble(std::string_view s, double& out) {
+   if (s.empty()) return false;
+   // strtod needs a terminated string; lat/lon values are short
+   char buf[64];
+   std::size_t n = std::min(s.size(), sizeof(buf) - 1);
+   std::memcpy(buf, s.data(), n);
+   buf[n] = '\0';
    char* end = nullptr;
-   unsigned long long v = std::strtoull(s.c_str(), &end, 10);
-   if (end == s.c_str()) return 0;
-   return static_cast<uint64_t>(v);
-}
-static int32_t parseInt32(const std::string& s) {
-   if (s.empty()) return 0;
-   char* end = nullptr;
-   long v = std::strtol(s.c_str(), &end, 10);
-   if (end == s.c_str()) return 0;
-   return static_cast<int32_t>(v);
-}
-static double parseDouble(const std::string& s) {
-   if (s.empty()) return 0.0;
-   char* end = nullptr;
-   double v = std::strtod(s.c_str(), &end);
-   if (end == s.c_str()) return 0.0;
-   return v;
+   out = std::strtod(buf, &end);
+   return end != buf;
 }
 
 
 // --- NEW helpers for fast queries ---
-static uint8_t to24h(uint8_t h, bool isPM) {
-   if (!isPM) return (h == 12) ? 0 : h;
-   return (h == 12) ? 12 : (uint8_t)(h + 12);
+// Parse "MM/DD/YYYY HH:MM:SS AM/PM" or ISO "YYYY-MM-DDTHH:MM:SS" -> epoch seconds
+uint32_t parseDateKey(std::string_view s) {
+   CivilTime t;
+   if (!parseTimestamp(s.data(), s.size(), t)) return kNullDate;
+
+
+   int64_t secs = toEpochSeconds(t);
+   if (secs <= 0 || secs > static_cast<int64_t>(UINT32_MAX)) return kNullDate;
+   return static_cast<uint32_t>(secs);
 }
 
 
-static uint64_t parseDateKey(const std::string& s) {
-   if (s.empty()) return 0;
+std::string formatDateKey(uint32_t key) {
+   if (key == kNullDate) return std::string();
 
 
-   unsigned mm=0, dd=0, yyyy=0, hh=0, mi=0, ss=0;
-   char ampm[3] = {};
-   int n = std::sscanf(s.c_str(), "%u/%u/%u %u:%u:%u %2s",
-                       &mm, &dd, &yyyy, &hh, &mi, &ss, ampm);
-   if (n < 7) return 0;
+   CivilTime t = fromEpochSeconds(key);
+   unsigned hour12 = t.hour % 12 == 0 ? 12 : t.hour % 12;
+   char buf[32];
+   std::snprintf(buf, sizeof(buf), "%02u/%02u/%04u %02u:%02u:%02u %s",
+                 (unsigned)t.month, (unsigned)t.day, (unsigned)t.year,
+                 hour12, (unsigned)t.minute, (unsigned)t.second, t.hour < 12 ? "AM" : "PM");
+   return buf;
+}
 
 
-   uint8_t hour24 = to24h((uint8_t)hh, (ampm[0] == 'P' || ampm[0] == 'p'));
+// Appends a number parsed as `Parsed`, or a null if the field is empty or
+// does not parse
+template <typename Parsed, typename T>
+static void pushNumber(NullableColumn<T>& col, std::string_view s) {
+   Parsed v{};
+   bool ok;
+   if constexpr (std::is_floating_point<Parsed>::value) ok = parseDouble(s, v);
+   else ok = parseInteger(s, v);
+   if (ok) col.push_back(static_cast<T>(v));
+   else col.push_null();
+}
 
+static void pushDate(NullableColumn<uint32_t>& col, std::string_view s) {
+   const uint32_t key = parseDateKey(s);
+   if (key != kNullDate) col.push_back(key);
+   else col.push_null();
+}
 
-   return ((uint64_t)yyyy << 40) |
-          ((uint64_t)mm   << 32) |
-          ((uint64_t)dd   << 24) |
-          ((uint64_t)hour24 << 16) |
-          ((uint64_t)mi   <<  8) |
-          (uint64_t)ss;
+
+// Appends to a dictionary column; a full dictionary is a load error
+template <typename Code>
+static bool pushCategory(DictColumn<Code>& col, std::string_view v, const char* name) {
+   if (col.push_back(v)) return true;
+   std::cerr << "Error: column " << name << " has more than "
+             << DictColumn<Code>::kMaxEntries << " distinct values" << std::endl;
+   return false;
 }
 
 
-static std::string upperCopy(const std::string& s) {
-   std::string t = s;
-   std::transform(t.begin(), t.end(), t.begin(),
-                  [](unsigned char c) { return (unsigned char)std::toupper(c); });
-   return t;
+// Appends to a free-text column; a heap past 4 GB is a load error
+static bool pushText(StringColumn& col, std::string_view v, const char* name) {
+   if (col.push_back(v)) return true;
+   std::cerr << "Error: column " << name << " holds more than "
+             << StringColumn::kMaxBytes << " bytes of text" << std::endl;
+   return false;
 }
 
 
-// Minimal CSV parser (reuse or expand as needed)
-std::vector<std::string> parseCSVLine(const std::string& line) {
-   std::vector<std::string> fields;
-   std::string current;
-   bool inQuotes = false;
-   for (std::size_t i = 0; i < line.size(); ++i) {
-       char c = line[i];
-       if (inQuotes) {
-           if (c == '"') {
-               if (i + 1 < line.size() && line[i + 1] == '"') {
-                   current += '"';
-                   ++i;
-               } else {
-                   inQuotes = false;
-               }
-           } else {
-               current += c;
-           }
-       } else {
-           if (c == '"') {
-               inQuotes = true;
-           } else if (c == ',') {
-               fields.push_back(current);
-               current.clear();
-           } else {
-               current += c;
+// Appends one tokenized record. Every field is copied exactly once, straight
+// from its view into the final column storage; categorical fields only
+// touch their dictionary the first time a value is seen. Fields of columns
+// outside `cols` are skipped unconverted.
+static bool appendRecord(ServiceRequestOoA& data, const std::vector<std::string_view>& f, ColumnSet cols) {
+   const auto want = [cols](Column c) { return cols.has(c); };
+   bool ok = true;
+   data.uniqueKey.push_back(parseU64(f[0]));
+
+
+   if (want(Column::createdDate)) pushDate(data.createdDate, f[1]);
+   if (want(Column::closedDate)) pushDate(data.closedDate, f[2]);
+   if (want(Column::agency)) ok &= pushCategory(data.agency, f[3], "agency");
+   if (want(Column::agencyName)) ok &= pushText(data.agencyName, f[4], "agencyName");
+
+
+   if (want(Column::complaintType)) ok &= pushCategory(data.complaintType, f[5], "complaintType");
+
+
+   if (want(Column::descriptor)) ok &= pushText(data.descriptor, f[6], "descriptor");
+   if (want(Column::additionalDetails)) ok &= pushText(data.additionalDetails, f[7], "additionalDetails");
+   if (want(Column::locationType)) ok &= pushCategory(data.locationType, f[8], "locationType");
+   if (want(Column::incidentZip)) pushNumber<uint32_t>(data.incidentZip, f[9]);
+   if (want(Column::incidentAddress)) ok &= pushText(data.incidentAddress, f[10], "incidentAddress");
+   if (want(Column::streetName)) ok &= pushText(data.streetName, f[11], "streetName");
+   if (want(Column::crossStreet1)) ok &= pushText(data.crossStreet1, f[12], "crossStreet1");
+   if (want(Column::crossStreet2)) ok &= pushText(data.crossStreet2, f[13], "crossStreet2");
+   if (want(Column::intersectionStreet1)) ok &= pushText(data.intersectionStreet1, f[14], "intersectionStreet1");
+   if (want(Column::intersectionStreet2)) ok &= pushText(data.intersectionStreet2, f[15], "intersectionStreet2");
+   if (want(Column::addressType)) ok &= pushCategory(data.addressType, f[16], "addressType");
+   if (want(Column::city)) ok &= pushText(data.city, f[17], "city");
+   if (want(Column::landmark)) ok &= pushText(data.landmark, f[18], "landmark");
+   if (want(Column::facilityType)) ok &= pushText(data.facilityType, f[19], "facilityType");
+   if (want(Column::status)) ok &= pushCategory(data.status, f[20], "status");
+   if (want(Column::dueDate)) pushDate(data.dueDate, f[21]);
+   if (want(Column::resolutionDescription)) ok &= pushText(data.resolutionDescription, f[22], "resolutionDescription");
+   if (want(Column::resolutionUpdatedDate)) pushDate(data.resolutionUpdatedDate, f[23]);
+   if (want(Column::communityBoard)) ok &= pushText(data.communityBoard, f[24], "communityBoard");
+   if (want(Column::councilDistrict)) pushNumber<long>(data.councilDistrict, f[25]);
+   if (want(Column::policePrecinct)) ok &= pushText(data.policePrecinct, f[26], "policePrecinct");
+   if (want(Column::bbl)) pushNumber<uint64_t>(data.bbl, f[27]);
+
+
+   if (want(Column::borough)) ok &= pushCategory(data.borough, f[28], "borough");
+   if (want(Column::boroughUpper)) {
+       thread_local std::string upper;
+       upper.assign(f[28].data(), f[28].size());
+       std::transform(upper.begin(), upper.end(), upper.begin(),
+                      [](unsigned char c) { return (char)std::toupper(c); });
+       ok &= pushCategory(data.boroughUpper, upper, "boroughUpper");
+   }
+
+
+   if (want(Column::xCoordinate)) pushNumber<long>(data.xCoordinate, f[29]);
+   if (want(Column::yCoordinate)) pushNumber<long>(data.yCoordinate, f[30]);
+   if (want(Column::channelType)) ok &= pushCategory(data.channelType, f[31], "channelType");
+   if (want(Column::parkFacilityName)) ok &= pushText(data.parkFacilityName, f[32], "parkFacilityName");
+   if (want(Column::parkBorough)) ok &= pushText(data.parkBorough, f[33], "parkBorough");
+   if (want(Column::vehicleType)) ok &= pushText(data.vehicleType, f[34], "vehicleType");
+   if (want(Column::taxiCompanyBorough)) ok &= pushText(data.taxiCompanyBorough, f[35], "taxiCompanyBorough");
+   if (want(Column::taxiPickupLocation)) ok &= pushText(data.taxiPickupLocation, f[36], "taxiPickupLocation");
+   if (want(Column::bridgeHighwayName)) ok &= pushText(data.bridgeHighwayName, f[37], "bridgeHighwayName");
+   if (want(Column::bridgeHighwayDirection)) ok &= pushText(data.bridgeHighwayDirection, f[38], "bridgeHighwayDirection");
+   if (want(Column::roadRamp)) ok &= pushText(data.roadRamp, f[39], "roadRamp");
+   if (want(Column::bridgeHighwaySegment)) ok &= pushText(data.bridgeHighwaySegment, f[40], "bridgeHighwaySegment");
+   if (want(Column::latitude)) pushNumber<double>(data.latitude, f[41]);
+   if (want(Column::longitude)) pushNumber<double>(data.longitude, f[42]);
+   return ok;
+}
+
+
+// Reserves `rows` rows in the columns of `cols`. Text heaps are sized from
+// the bytes per row of `sample` (rows already parsed), if given, plus 5%.
+static void reserveRows(ServiceRequestOoA& data, std::size_t rows, ColumnSet cols,
+                        const ServiceRequestOoA* sample = nullptr) {
+   forEachColumnIn(cols, [&](const char*, auto member) {
+       auto& col = data.*member;
+       col.reserve(rows);
+       if constexpr (std::is_same_v<std::remove_reference_t<decltype(col)>, StringColumn>) {
+           if (sample && !sample->uniqueKey.empty()) {
+               const double perRow = static_cast<double>((sample->*member).heapBytes()) / sample->uniqueKey.size();
+               col.reserveBytes(static_cast<std::size_t>(
+                   std::min(perRow * rows * 1.05, static_cast<double>(StringColumn::kMaxBytes))));
            }
        }
-   }
-   fields.push_back(current);
-   return fields;
+   });
 }
 
 
-// Loader for OoA structure
-bool loadServiceRequestOoA(const std::string& filename, ServiceRequestOoA& data, size_t maxRecords) {
+// Stream mode: one std::string per line via getline, then tokenized in place
+static bool loadStream(const std::string& filename, ServiceRequestOoA& data, size_t maxRecords,
+                       ColumnSet cols) {
    std::ifstream file(filename);
    if (!file.is_open()) {
        std::cerr << "Error opening file: " << filename << std::endl;
@@ -129,79 +213,389 @@ bool loadServiceRequestOoA(const std::string& filename, ServiceRequestOoA& data,
 
 
    std::string line;
+   std::vector<std::string_view> f;
+   std::string scratch;
    // Skip header
    if (std::getline(file, line)) { }
 
 
    while (std::getline(file, line)) {
-       auto f = parseCSVLine(line);
+       if (splitCSVFields(line.data(), line.size(), f, scratch) < 43) continue;
+       if (!appendRecord(data, f, cols)) return false;
+       if (data.uniqueKey.size() >= maxRecords) break;
+   }
+   return true;
+}
+
+
+// Mapped mode: tokenize records directly out of the mapped file in one SIMD
+// pass per record. No per-line string and no per-field temporaries; quoted
+// newlines are handled correctly.
+static bool loadMapped(const std::string& filename, ServiceRequestOoA& data, size_t maxRecords,
+                       ColumnSet cols) {
+   MappedFile file;
+   if (!file.open(filename)) return false;
+
+
+   const char* cur = file.data();
+   const char* end = cur + file.size();
+   std::vector<std::string_view> f;
+   f.reserve(44);
+   std::string scratch;
+
+
+   // Skip header
+   if (cur < end) cur = findRecordEnd(cur, end) + 1;
+
+
+   // Size the columns once from the average record length of a short prefix
+   constexpr std::size_t SAMPLE_ROWS = 4096;
+   const char* sampleStart = cur;
+   bool reserved = false;
+
+
+   while (cur < end) {
+       cur = splitCSVRecord(cur, end, f, scratch);
        if (f.size() < 43) continue;
 
 
-       data.uniqueKey.push_back(parseU64(f[0]));
+       if (!appendRecord(data, f, cols)) return false;
+       if (data.uniqueKey.size() >= maxRecords) break;
+
+
+       if (!reserved && data.uniqueKey.size() == SAMPLE_ROWS && cur < end) {
+           double avgBytes = static_cast<double>(cur - sampleStart) / SAMPLE_ROWS;
+           double estimate = SAMPLE_ROWS + static_cast<double>(end - cur) / avgBytes * 1.05;
+           reserveRows(data, std::min<std::size_t>(maxRecords, static_cast<std::size_t>(estimate)), cols, &data);
+           reserved = true;
+       }
+   }
+   return true;
+}
+
+
+// Moves the first `count` rows of a parsed chunk onto the end of a column
+template <typename T>
+static bool appendRows(std::vector<T>& dst, std::vector<T>& src, std::size_t count, const char*) {
+   dst.insert(dst.end(), std::make_move_iterator(src.begin()),
+              std::make_move_iterator(src.begin() + static_cast<std::ptrdiff_t>(count)));
+   return true;
+}
+template <typename T>
+static bool appendRows(NullableColumn<T>& dst, NullableColumn<T>& src, std::size_t count, const char*) {
+   dst.append(src, count);
+   return true;
+}
+static bool appendRows(StringColumn& dst, StringColumn& src, std::size_t count, const char* name) {
+   if (dst.append(src, count)) return true;
+   std::cerr << "Error: column " << name << " holds more than "
+             << StringColumn::kMaxBytes << " bytes of text" << std::endl;
+   return false;
+}
+template <typename Code>
+static bool appendRows(DictColumn<Code>& dst, DictColumn<Code>& src, std::size_t count, const char* name) {
+   if (dst.append(src, count)) return true;
+   std::cerr << "Error: column " << name << " has more than "
+             << DictColumn<Code>::kMaxEntries << " distinct values" << std::endl;
+   return false;
+}
+
+template <typename T>
+static void clearRows(std::vector<T>& col) { col.clear(); }
+template <typename Code>
+static void clearRows(DictColumn<Code>& col) { col.clearRows(); }
+static void clearRows(StringColumn& col) { col.clear(); }
+template <typename T>
+static void clearRows(NullableColumn<T>& col) { col.clear(); }
+
+
+// Pipelined mode. Three stages connected by bounded lock-free queues:
+//   reader   one thread, large sequential reads, each block cut after its
+//            last complete record (the rest is carried into the next block)
+//   parsers  N threads, each turning a block into a chunk of columns with
+//            its own dictionaries (tokenizing and all field conversion)
+//   append   the calling thread, moving chunks onto the columns in file
+//            order and re-coding dictionary values
+// Blocks and chunks come from fixed pools recycled through free queues, so
+// a stage that falls behind stalls the others instead of memory growing.
+// Results (including dictionary codes) equal the Mapped loader's.
+static constexpr std::size_t kReadBlockBytes = std::size_t(4) << 20;
+
+struct RawBlock {
+   std::size_t seq = 0;
+   std::vector<char> bytes;
+   std::size_t begin = 0;   // first record (past the header in block 0)
+   std::size_t end = 0;     // one past the last complete record
+};
+
+struct ParsedChunk {
+   std::size_t seq = 0;
+   std::size_t bytes = 0;   // CSV bytes the rows came from
+   ServiceRequestOoA rows;
+};
+
+static bool loadPipelined(const std::string& filename, ServiceRequestOoA& data, size_t maxRecords,
+                          ColumnSet cols) {
+   std::ifstream file(filename, std::ios::binary);
+   if (!file.is_open()) {
+       std::cerr << "Error opening file: " << filename << std::endl;
+       return false;
+   }
+   file.seekg(0, std::ios::end);
+   const double fileBytes = static_cast<double>(file.tellg());
+   file.seekg(0, std::ios::beg);
+
+   const unsigned parsers = std::max(1u, ThreadPool::defaultWorkerCount() - 1);
+   const std::size_t poolSize = parsers + 2;
+
+   std::vector<RawBlock> rawPool(poolSize);
+   std::vector<ParsedChunk> chunkPool(poolSize);
+   BoundedQueue<RawBlock*> freeRaw(poolSize), rawQueue(poolSize);
+   BoundedQueue<ParsedChunk*> freeChunks(poolSize), chunkQueue(poolSize);
+   for (auto& b : rawPool) freeRaw.push(&b);
+   for (auto& c : chunkPool) freeChunks.push(&c);
+
+   std::atomic<bool> failed{false};
+   std::atomic<bool> stop{false};   // record cap reached: no more reads
+
+   // Stage 1: read blocks, cut at record boundaries
+   std::thread reader([&] {
+       std::vector<char> carry;
+       bool header = true;
+       for (std::size_t seq = 0; !stop.load(std::memory_order_relaxed) && !failed.load(std::memory_order_relaxed); ++seq) {
+           RawBlock* b;
+           if (!freeRaw.pop(b)) break;
+           b->bytes.assign(carry.begin(), carry.end());
+           bool eof = false;
+           std::size_t cut = 0;
+           for (;;) {
+               // Read until the block holds at least one complete record
+               const std::size_t have = b->bytes.size();
+               b->bytes.resize(have + kReadBlockBytes);
+               file.read(b->bytes.data() + have, static_cast<std::streamsize>(kReadBlockBytes));
+               b->bytes.resize(have + static_cast<std::size_t>(file.gcount()));
+               eof = !file;
+               const char* base = b->bytes.data();
+               cut = eof ? b->bytes.size()
+                         : static_cast<std::size_t>(lastRecordEnd(base, base + b->bytes.size()) - base);
+               if (cut > 0 || eof) break;
+           }
+           carry.assign(b->bytes.begin() + static_cast<std::ptrdiff_t>(cut), b->bytes.end());
+           b->seq = seq;
+           b->begin = 0;
+           b->end = cut;
+           if (header && cut > 0) {
+               const char* base = b->bytes.data();
+               b->begin = std::min(cut, static_cast<std::size_t>(findRecordEnd(base, base + cut) - base) + 1);
+               header = false;
+           }
+           rawQueue.push(b);
+           if (eof) break;
+       }
+       rawQueue.close();
+   });
+
+   // Stage 2: tokenize and convert blocks into chunks of columns
+   std::atomic<unsigned> parsersLeft{parsers};
+   std::vector<std::thread> parserThreads;
+   for (unsigned t = 0; t < parsers; ++t) {
+       parserThreads.emplace_back([&] {
+           std::vector<std::string_view> f;
+           f.reserve(44);
+           std::string scratch;
+           for (;;) {
+               // Take the chunk before the block: a worker holding a block
+               // can then always finish it, whatever the append stage holds
+               ParsedChunk* c;
+               RawBlock* b;
+               if (!freeChunks.pop(c)) break;
+               if (!rawQueue.pop(b)) { freeChunks.push(c); break; }
+
+               forEachColumn([&](const char*, auto member) { clearRows(c->rows.*member); });
+               const char* cur = b->bytes.data() + b->begin;
+               const char* end = b->bytes.data() + b->end;
+               while (cur < end) {
+                   cur = splitCSVRecord(cur, end, f, scratch);
+                   if (f.size() < 43) continue;
+                   if (!appendRecord(c->rows, f, cols)) { failed.store(true); break; }
+               }
+               c->seq = b->seq;
+               c->bytes = b->end - b->begin;
+               freeRaw.push(b);
+               chunkQueue.push(c);
+           }
+           if (parsersLeft.fetch_sub(1) == 1) chunkQueue.close();
+       });
+   }
 
+   // Stage 3: append chunks in file order
+   std::vector<ParsedChunk*> pending;   // arrived ahead of their turn
+   std::size_t nextSeq = 0;
+   bool reserved = false;
+   ParsedChunk* c;
+   while (chunkQueue.pop(c)) {
+       pending.push_back(c);
+       for (bool progress = true; progress;) {
+           progress = false;
+           for (std::size_t i = 0; i < pending.size(); ++i) {
+               if (pending[i]->seq != nextSeq) continue;
+               ParsedChunk* next = pending[i];
+               pending.erase(pending.begin() + static_cast<std::ptrdiff_t>(i));
+               const std::size_t rows = next->rows.uniqueKey.size();
+               const std::size_t room = maxRecords - std::min(maxRecords, data.uniqueKey.size());
+               const std::size_t take = std::min(rows, room);
+               if (!failed.load() && take > 0) {
+                   // Size the columns once from the first chunk's bytes per record
+                   if (!reserved && rows > 0) {
+                       const double estimate = fileBytes / (static_cast<double>(next->bytes) / rows) * 1.05;
+                       reserveRows(data, std::min<std::size_t>(maxRecords, static_cast<std::size_t>(estimate)),
+                                   cols, &next->rows);
+                       reserved = true;
+                   }
+                   bool ok = true;
+                   forEachColumnIn(cols, [&](const char* name, auto member) {
+                       ok = ok && appendRows(data.*member, next->rows.*member, take, name);
+                   });
+                   if (!ok) failed.store(true);
+               }
+               if (data.uniqueKey.size() >= maxRecords) stop.store(true);
+               freeChunks.push(next);
+               ++nextSeq;
+               progress = true;
+               break;
+           }
+       }
+   }
 
-       data.createdDate.push_back(f[1]);
-       data.createdKey.push_back(parseDateKey(f[1]));          // NEW
+   reader.join();
+   for (auto& t : parserThreads) t.join();
+   return !failed.load();
+}
 
 
-       data.closedDate.push_back(f[2]);
-       data.agency.push_back(f[3]);
-       data.agencyName.push_back(f[4]);
+// Loader for OoA structure
+bool loadServiceRequestOoA(const std::string& filename, ServiceRequestOoA& data, size_t maxRecords,
+                           IngestMode mode, ColumnSet columns) {
+   const ColumnSet cols = columns | ColumnSet{Column::uniqueKey};
+   data.loaded = cols;
+   data.origin = ColumnOrigin{filename, false, maxRecords, mode};
+   if (mode == IngestMode::Stream) return loadStream(filename, data, maxRecords, cols);
+   if (mode == IngestMode::Pipelined) return loadPipelined(filename, data, maxRecords, cols);
+   return loadMapped(filename, data, maxRecords, cols);
+}
 
 
-       data.complaintType.push_back(f[5]);
-       std::string lower = f[5];
-       std::transform(lower.begin(), lower.end(), lower.begin(),
-                      [](unsigned char c) { return (unsigned char)std::tolower(c); });
-       data.complaintTypeLower.push_back(lower);
+bool ensureColumns(ServiceRequestOoA& data, ColumnSet columns) {
+   const ColumnSet missing = columns - data.loaded;
+   if (missing.empty()) return true;
+   if (data.origin.path.empty()) {
+       std::cerr << "Error: columns " << missing.names() << " were not loaded and have no source" << std::endl;
+       return false;
+   }
 
+   // Read just the missing columns (uniqueKey comes along to match rows)
+   const ColumnOrigin& from = data.origin;
+   ServiceRequestOoA extra;
+   const bool ok = from.snapshot ? loadSnapshotOoA(from.path, extra, nullptr, &missing)
+                                 : loadServiceRequestOoA(from.path, extra, from.maxRecords, from.mode, missing);
+   if (!ok) {
+       std::cerr << "Error: failed to load columns " << missing.names() << " from " << from.path << std::endl;
+       return false;
+   }
+   if (extra.uniqueKey != data.uniqueKey) {
+       std::cerr << "Error: " << from.path << " no longer holds the loaded rows" << std::endl;
+       return false;
+   }
 
-       data.descriptor.push_back(f[6]);
-       data.additionalDetails.push_back(f[7]);
-       data.locationType.push_back(f[8]);
-       data.incidentZip.push_back(parseZip(f[9]));
-       data.incidentAddress.push_back(f[10]);
-       data.streetName.push_back(f[11]);
-       data.crossStreet1.push_back(f[12]);
-       data.crossStreet2.push_back(f[13]);
-       data.intersectionStreet1.push_back(f[14]);
-       data.intersectionStreet2.push_back(f[15]);
-       data.addressType.push_back(f[16]);
-       data.city.push_back(f[17]);
-       data.landmark.push_back(f[18]);
-       data.facilityType.push_back(f[19]);
-       data.status.push_back(f[20]);
-       data.dueDate.push_back(f[21]);
-       data.resolutionDescription.push_back(f[22]);
-       data.resolutionUpdatedDate.push_back(f[23]);
-       data.communityBoard.push_back(f[24]);
-       data.councilDistrict.push_back(parseInt16(f[25]));
-       data.policePrecinct.push_back(f[26]);
-       data.bbl.push_back(parseU64(f[27]));
+   forEachColumnIn(missing, [&](const char*, auto member) { data.*member = std::move(extra.*member); });
+   data.loaded = data.loaded | missing;
+   return true;
+}
 
 
-       data.borough.push_back(f[28]);
-       data.boroughUpper.push_back(upperCopy(f[28]));          // NEW
+bool ColumnSet::parse(std::string_view names, ColumnSet& out) {
+   out = ColumnSet{};
+   while (!names.empty()) {
+       const std::size_t comma = names.find(',');
+       const std::string_view name = names.substr(0, comma);
+       names = comma == std::string_view::npos ? std::string_view() : names.substr(comma + 1);
+       if (name.empty()) continue;
+
+       std::size_t index = 0, found = static_cast<std::size_t>(Column::count);
+       forEachColumn([&](const char* col, auto) {
+           if (name == col) found = index;
+           ++index;
+       });
+       if (found == static_cast<std::size_t>(Column::count)) {
+           std::cerr << "Error: unknown column \"" << name << "\"" << std::endl;
+           return false;
+       }
+       out.add(static_cast<Column>(found));
+   }
+   return true;
+}
 
+std::string ColumnSet::names() const {
+   std::string out;
+   forEachColumnIn(*this, [&](const char* name, auto) {
+       if (!out.empty()) out += ',';
+       out += name;
+   });
+   return out;
+}
 
-       data.xCoordinate.push_back(parseInt32(f[29]));
-       data.yCoordinate.push_back(parseInt32(f[30]));
-       data.channelType.push_back(f[31]);
-       data.parkFacilityName.push_back(f[32]);
-       data.parkBorough.push_back(f[33]);
-       data.vehicleType.push_back(f[34]);
-       data.taxiCompanyBorough.push_back(f[35]);
-       data.taxiPickupLocation.push_back(f[36]);
-       data.bridgeHighwayName.push_back(f[37]);
-       data.bridgeHighwayDirection.push_back(f[38]);
-       data.roadRamp.push_back(f[39]);
-       data.bridgeHighwaySegment.push_back(f[40]);
-       data.latitude.push_back(parseDouble(f[41]));
-       data.longitude.push_back(parseDouble(f[42]));
 
+bool BatchReaderOoA::open(const std::string& filename, ColumnSet columns) {
+   if (!file_.open(filename)) return false;
+   columns_ = columns | ColumnSet{Column::uniqueKey};
+   cur_ = file_.data();
+   end_ = cur_ + file_.size();
+   released_ = cur_;
+   batchStart_ = rowsRead_ = 0;
+   fields_.reserve(44);
 
-       if (data.uniqueKey.size() >= maxRecords) break;
+   // Skip header
+   if (cur_ < end_) cur_ = findRecordEnd(cur_, end_) + 1;
+   return true;
+}
+
+bool BatchReaderOoA::next(ServiceRequestOoA& data, std::size_t maxRows) {
+   forEachColumn([&](const char*, auto member) { clearRows(data.*member); });
+   data.loaded = columns_;
+   reserveRows(data, maxRows, columns_);
+   batchStart_ = rowsRead_;
+
+   while (cur_ < end_ && data.uniqueKey.size() < maxRows) {
+       cur_ = splitCSVRecord(cur_, end_, fields_, scratch_);
+       if (fields_.size() < 43) continue;
+       if (!appendRecord(data, fields_, columns_)) return false;
    }
+   rowsRead_ += data.uniqueKey.size();
+
+   // Everything up to here is parsed into the columns; the page holding the
+   // cut is kept and dropped with the next batch
+   released_ = file_.release(released_, cur_);
    return true;
-}
\ No newline at end of file
+}
+
+double BatchReaderOoA::progress() const {
+   if (file_.size() == 0) return 1.0;
+   return static_cast<double>(cur_ - file_.data()) / static_cast<double>(file_.size());
+}
+
+
+template <typename Code>
+static std::size_t columnBytes(const DictColumn<Code>& col) { return col.memoryBytes(); }
+template <typename T>
+static std::size_t columnBytes(const std::vector<T>& col) { return allocatedBytes(col); }
+static std::size_t columnBytes(const StringColumn& col) { return col.memoryBytes(); }
+template <typename T>
+static std::size_t columnBytes(const NullableColumn<T>& col) { return col.memoryBytes(); }
+
+std::vector<ColumnMemory> columnMemoryOoA(const ServiceRequestOoA& data) {
+   std::vector<ColumnMemory> out;
+   forEachColumnIn(data.loaded, [&](const char* name, auto member) {
+       out.push_back({name, columnBytes(data.*member)});
+   });
+   return out;
+}
@@ -2,57 +2,273 @@
 #include <cstddef>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <cstdint>
+#include <initializer_list>
+#include "DictColumn.h"
+#include "NullableColumn.h"
+#include "StringColumn.h"
+#include "../common/MappedFile.h"
 
-// Object-of-Arrays (OoA) structure for all NYC 311 fields
+// Columns of ServiceRequestOoA, in struct (and forEachColumn) order
+enum class Column : unsigned {
+   uniqueKey, createdDate, closedDate, agency, agencyName, complaintType, descriptor,
+   additionalDetails, locationType, incidentZip, incidentAddress, streetName, crossStreet1,
+   crossStreet2, intersectionStreet1, intersectionStreet2, addressType, city, landmark,
+   facilityType, status, dueDate, resolutionDescription, resolutionUpdatedDate, communityBoard,
+   councilDistrict, policePrecinct, bbl, borough, xCoordinate, yCoordinate, channelType,
+   parkFacilityName, parkBorough, vehicleType, taxiCompanyBorough, taxiPickupLocation,
+   bridgeHighwayName, bridgeHighwayDirection, roadRamp, bridgeHighwaySegment, latitude,
+   longitude, boroughUpper,
+   count
+};
+
+// A set of columns (a projection), one bit per Column
+class ColumnSet {
+public:
+   ColumnSet() = default;
+   ColumnSet(std::initializer_list<Column> cols) {
+      for (Column c : cols) add(c);
+   }
+   static ColumnSet all() {
+      ColumnSet s;
+      s.bits_ = (uint64_t(1) << static_cast<unsigned>(Column::count)) - 1;
+      return s;
+   }
+   // Comma-separated column names ("latitude,longitude"). Returns false and
+   // prints the offending name if one is unknown.
+   static bool parse(std::string_view names, ColumnSet& out);
+
+   ColumnSet& add(Column c) { bits_ |= bit(static_cast<std::size_t>(c)); return *this; }
+   bool has(Column c) const { return has(static_cast<std::size_t>(c)); }
+   bool has(std::size_t index) const { return (bits_ & bit(index)) != 0; }
+   bool empty() const { return bits_ == 0; }
+   std::size_t count() const { return static_cast<std::size_t>(__builtin_popcountll(bits_)); }
+
+   ColumnSet operator|(ColumnSet o) const { ColumnSet s; s.bits_ = bits_ | o.bits_; return s; }
+   ColumnSet operator-(ColumnSet o) const { ColumnSet s; s.bits_ = bits_ & ~o.bits_; return s; }
+   bool operator==(ColumnSet o) const { return bits_ == o.bits_; }
+   bool operator!=(ColumnSet o) const { return bits_ != o.bits_; }
+
+   // "a,b,c" in column order
+   std::string names() const;
+
+private:
+   static uint64_t bit(std::size_t index) { return uint64_t(1) << index; }
+   uint64_t bits_ = 0;
+};
+static_assert(static_cast<unsigned>(Column::count) <= 64, "ColumnSet holds 64 columns");
+
+// How the loader reads the CSV
+enum class IngestMode {
+   Stream,    // std::ifstream + getline, one std::string per line
+   Mapped,    // mmap the file and tokenize records in place, one thread
+   Pipelined  // reader thread -> parser threads -> in-order column append (default)
+};
+
+// Where a load came from, so columns left out of it can be read later
+struct ColumnOrigin {
+   std::string path;               // empty: not loaded from a file
+   bool snapshot = false;          // path is a snapshot (else the CSV)
+   std::size_t maxRecords = 0;
+   IngestMode mode = IngestMode::Pipelined;
+};
+
+// Object-of-Arrays (OoA) structure for all NYC 311 fields.
+// Low-cardinality categorical columns are dictionary-encoded (DictColumn):
+// one byte per row for the handful-of-values fields, two for the ones with
+// a few hundred distinct values. Free-text columns are StringColumns (one
+// byte heap + offsets, read as string_view). Date columns are packed
+// timestamps (see parseDateKey below); render them with formatDateKey only
+// when printing. Dates and the other numeric fields are NullableColumns:
+// an empty or unparseable field is a null in the validity bitmap (its
+// value slot holds 0), not a magic value that aggregates would count.
+//
+// A load can be projected onto a subset of the columns (ColumnSet); the
+// others stay empty until ensureColumns() reads them. `loaded` says which
+// columns hold rows. uniqueKey is always loaded: its size is the row count.
 struct ServiceRequestOoA {
    std::vector<uint64_t> uniqueKey;
-   std::vector<std::string> createdDate;
-   std::vector<std::string> closedDate;
-   std::vector<std::string> agency;
-   std::vector<std::string> agencyName;
-   std::vector<std::string> complaintType;
-   std::vector<std::string> complaintTypeLower;
-   std::vector<std::string> descriptor;
-   std::vector<std::string> additionalDetails;
-   std::vector<std::string> locationType;
-   std::vector<uint32_t> incidentZip;
-   std::vector<std::string> incidentAddress;
-   std::vector<std::string> streetName;
-   std::vector<std::string> crossStreet1;
-   std::vector<std::string> crossStreet2;
-   std::vector<std::string> intersectionStreet1;
-   std::vector<std::string> intersectionStreet2;
-   std::vector<std::string> addressType;
-   std::vector<std::string> city;
-   std::vector<std::string> landmark;
-   std::vector<std::string> facilityType;
-   std::vector<std::string> status;
-   std::vector<std::string> dueDate;
-   std::vector<std::string> resolutionDescription;
-   std::vector<std::string> resolutionUpdatedDate;
-   std::vector<std::string> communityBoard;
-   std::vector<int16_t> councilDistrict;
-   std::vector<std::string> policePrecinct;
-   std::vector<uint64_t> bbl;
-   std::vector<std::string> borough;
-   std::vector<int32_t> xCoordinate;
-   std::vector<int32_t> yCoordinate;
-   std::vector<std::string> channelType;
-   std::vector<std::string> parkFacilityName;
-   std::vector<std::string> parkBorough;
-   std::vector<std::string> vehicleType;
-   std::vector<std::string> taxiCompanyBorough;
-   std::vector<std::string> taxiPickupLocation;
-   std::vector<std::string> bridgeHighwayName;
-   std::vector<std::string> bridgeHighwayDirection;
-   std::vector<std::string> roadRamp;
-   std::vector<std::string> bridgeHighwaySegment;
-   std::vector<double> latitude;
-   std::vector<double> longitude;
-   std::vector<uint64_t> createdKey;
-   std::vector<std::string> boroughUpper;
+   NullableColumn<uint32_t> createdDate;
+   NullableColumn<uint32_t> closedDate;
+   DictColumn<uint16_t> agency;
+   StringColumn agencyName;
+   DictColumn<uint16_t> complaintType;
+   StringColumn descriptor;
+   StringColumn additionalDetails;
+   DictColumn<uint16_t> locationType;
+   NullableColumn<uint32_t> incidentZip;
+   StringColumn incidentAddress;
+   StringColumn streetName;
+   StringColumn crossStreet1;
+   StringColumn crossStreet2;
+   StringColumn intersectionStreet1;
+   StringColumn intersectionStreet2;
+   DictColumn<uint8_t> addressType;
+   StringColumn city;
+   StringColumn landmark;
+   StringColumn facilityType;
+   DictColumn<uint8_t> status;
+   NullableColumn<uint32_t> dueDate;
+   StringColumn resolutionDescription;
+   NullableColumn<uint32_t> resolutionUpdatedDate;
+   StringColumn communityBoard;
+   NullableColumn<int16_t> councilDistrict;
+   StringColumn policePrecinct;
+   NullableColumn<uint64_t> bbl;
+   DictColumn<uint8_t> borough;
+   NullableColumn<int32_t> xCoordinate;
+   NullableColumn<int32_t> yCoordinate;
+   DictColumn<uint8_t> channelType;
+   StringColumn parkFacilityName;
+   StringColumn parkBorough;
+   StringColumn vehicleType;
+   StringColumn taxiCompanyBorough;
+   StringColumn taxiPickupLocation;
+   StringColumn bridgeHighwayName;
+   StringColumn bridgeHighwayDirection;
+   StringColumn roadRamp;
+   StringColumn bridgeHighwaySegment;
+   NullableColumn<double> latitude;
+   NullableColumn<double> longitude;
+   DictColumn<uint8_t> boroughUpper;
+
+   ColumnSet loaded = ColumnSet::all();
+   ColumnOrigin origin;
+};
+
+// Visits every column as (name, pointer-to-member), in struct order.
+// Lets generic code (reserve, serialization, accounting) touch all columns
+// of one or several ServiceRequestOoA instances: `(data.*member).size()`.
+template <typename Fn>
+constexpr void forEachColumn(Fn&& fn) {
+   fn("uniqueKey", &ServiceRequestOoA::uniqueKey);
+   fn("createdDate", &ServiceRequestOoA::createdDate);
+   fn("closedDate", &ServiceRequestOoA::closedDate);
+   fn("agency", &ServiceRequestOoA::agency);
+   fn("agencyName", &ServiceRequestOoA::agencyName);
+   fn("complaintType", &ServiceRequestOoA::complaintType);
+   fn("descriptor", &ServiceRequestOoA::descriptor);
+   fn("additionalDetails", &ServiceRequestOoA::additionalDetails);
+   fn("locationType", &ServiceRequestOoA::locationType);
+   fn("incidentZip", &ServiceRequestOoA::incidentZip);
+   fn("incidentAddress", &ServiceRequestOoA::incidentAddress);
+   fn("streetName", &ServiceRequestOoA::streetName);
+   fn("crossStreet1", &ServiceRequestOoA::crossStreet1);
+   fn("crossStreet2", &ServiceRequestOoA::crossStreet2);
+   fn("intersectionStreet1", &ServiceRequestOoA::intersectionStreet1);
+   fn("intersectionStreet2", &ServiceRequestOoA::intersectionStreet2);
+   fn("addressType", &ServiceRequestOoA::addressType);
+   fn("city", &ServiceRequestOoA::city);
+   fn("landmark", &ServiceRequestOoA::landmark);
+   fn("facilityType", &ServiceRequestOoA::facilityType);
+   fn("status", &ServiceRequestOoA::status);
+   fn("dueDate", &ServiceRequestOoA::dueDate);
+   fn("resolutionDescription", &ServiceRequestOoA::resolutionDescription);
+   fn("resolutionUpdatedDate", &ServiceRequestOoA::resolutionUpdatedDate);
+   fn("communityBoard", &ServiceRequestOoA::communityBoard);
+   fn("councilDistrict", &ServiceRequestOoA::councilDistrict);
+   fn("policePrecinct", &ServiceRequestOoA::policePrecinct);
+   fn("bbl", &ServiceRequestOoA::bbl);
+   fn("borough", &ServiceRequestOoA::borough);
+   fn("xCoordinate", &ServiceRequestOoA::xCoordinate);
+   fn("yCoordinate", &ServiceRequestOoA::yCoordinate);
+   fn("channelType", &ServiceRequestOoA::channelType);
+   fn("parkFacilityName", &ServiceRequestOoA::parkFacilityName);
+   fn("parkBorough", &ServiceRequestOoA::parkBorough);
+   fn("vehicleType", &ServiceRequestOoA::vehicleType);
+   fn("taxiCompanyBorough", &ServiceRequestOoA::taxiCompanyBorough);
+   fn("taxiPickupLocation", &ServiceRequestOoA::taxiPickupLocation);
+   fn("bridgeHighwayName", &ServiceRequestOoA::bridgeHighwayName);
+   fn("bridgeHighwayDirection", &ServiceRequestOoA::bridgeHighwayDirection);
+   fn("roadRamp", &ServiceRequestOoA::roadRamp);
+   fn("bridgeHighwaySegment", &ServiceRequestOoA::bridgeHighwaySegment);
+   fn("latitude", &ServiceRequestOoA::latitude);
+   fn("longitude", &ServiceRequestOoA::longitude);
+   fn("boroughUpper", &ServiceRequestOoA::boroughUpper);
+}
+
+constexpr std::size_t columnCountOoA() {
+   std::size_t n = 0;
+   forEachColumn([&n](const char*, auto) { ++n; });
+   return n;
+}
+static_assert(columnCountOoA() == static_cast<std::size_t>(Column::count),
+              "Column must list every forEachColumn() column, in order");
+
+// forEachColumn() restricted to the columns in `cols`
+template <typename Fn>
+void forEachColumnIn(ColumnSet cols, Fn&& fn) {
+   std::size_t index = 0;
+   forEachColumn([&](const char* name, auto member) {
+      if (cols.has(index++)) fn(name, member);
+   });
+}
+
+// Value slot of a null date (empty or unparseable field). No valid key is
+// 0, so a date range starting at 1 or later never matches a null.
+constexpr uint32_t kNullDate = 0;
+
+// Parses a created/closed/due date into seconds since 1970-01-01 of its
+// civil (NYC local) time, so keys order correctly and `closed - created` is
+// a duration in seconds. Returns kNullDate for empty/invalid input or dates
+// outside 1970-2106.
+uint32_t parseDateKey(std::string_view s);
+
+// Renders a date key as "MM/DD/YYYY HH:MM:SS AM"; "" for kNullDate
+std::string formatDateKey(uint32_t key);
+
+// Loader function declaration (must come after struct definition).
+// `columns` projects the load: only those columns (plus uniqueKey) are
+// parsed and stored. Every field is still tokenized, but the skipped ones
+// are never converted, copied or allocated.
+bool loadServiceRequestOoA(const std::string& filename, ServiceRequestOoA& data, size_t maxRecords = 14000000,
+                           IngestMode mode = IngestMode::Pipelined, ColumnSet columns = ColumnSet::all());
+
+// Makes sure `columns` hold data. Missing ones are read from data.origin
+// (a projected CSV parse or snapshot load of just those columns) and must
+// come back with the same uniqueKey column, i.e. the same rows. Returns
+// false, leaving data as it was, if they cannot be read.
+bool ensureColumns(ServiceRequestOoA& data, ColumnSet columns);
+
+// Reads the CSV a batch of rows at a time, for streaming execution over
+// files too large to load whole. Each next() replaces the rows in `data`
+// but keeps its dictionaries, so codes stay comparable across batches, and
+// releases the file pages already consumed: resident memory is one batch,
+// not the file.
+class BatchReaderOoA {
+public:
+   // Batches hold `columns` (plus uniqueKey) only
+   bool open(const std::string& filename, ColumnSet columns = ColumnSet::all());
+
+   // Loads up to maxRows further records into data, dropping its previous
+   // rows. Returns false on a load error; data is empty at end of file.
+   bool next(ServiceRequestOoA& data, std::size_t maxRows);
+
+   // Records loaded by all earlier next() calls, i.e. the row number of
+   // the first row of the current batch once next() returns
+   std::size_t batchStart() const { return batchStart_; }
+   // Share of the file consumed so far, in [0, 1]
+   double progress() const;
+
+private:
+   MappedFile file_;
+   const char* cur_ = nullptr;
+   const char* end_ = nullptr;
+   const char* released_ = nullptr;   // pages before this are dropped
+   std::size_t batchStart_ = 0;
+   std::size_t rowsRead_ = 0;
+   ColumnSet columns_;
+   std::vector<std::string_view> fields_;
+   std::string scratch_;
+};
+
+// Heap bytes held by one column (capacity, not size; string heaps and
+// dictionaries included)
+struct ColumnMemory {
+   const char* name;
+   std::size_t bytes;
 };
 
-// Loader function declaration (must come after struct definition)
-bool loadServiceRequestOoA(const std::string& filename, ServiceRequestOoA& data, size_t maxRecords = 14000000);
\ No newline at end of file
+// One entry per loaded column, in struct order
+std::vector<ColumnMemory> columnMemoryOoA(const ServiceRequestOoA& data);
@@ -0,0 +1,497 @@
+#include "Snapshot.h"
+#include "../common/MappedFile.h"
+
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+#include <vector>
+#include <omp.h>
+#include <sys/stat.h>
+
+namespace {
+
+constexpr char     kMagic[8]      = {'N', 'Y', 'C', '3', '1', '1', 'O', 'A'};
+constexpr uint32_t kVersion       = 2;
+constexpr uint32_t kEndianMarker  = 0x01020304u;
+constexpr uint64_t kAlign         = 64;
+
+enum ColumnKind : uint32_t { kFixed = 0, kString = 1, kDict = 2, kNullable = 3 };
+
+struct SnapshotHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t endian;
+    uint64_t rowCount;
+    uint64_t columnCount;
+    uint64_t schemaHash;
+    uint64_t sourceSize;
+    int64_t  sourceMtime;
+    uint64_t sourceMaxRecords;
+};
+
+struct SnapshotColumn {
+    char     name[48];
+    uint32_t kind;
+    uint32_t elemSize;     // fixed / nullable: sizeof(T); string: offset width (4); dict: sizeof(code)
+    uint64_t offset;       // start of the region in the file
+    uint64_t bytes;        // region size (offsets + heap for strings)
+    uint64_t checksum;
+};
+
+// 64-bit streaming checksum: multiply-xor over 8-byte words. Not
+// cryptographic; it only has to catch truncated or stale files.
+class Checksum64 {
+public:
+    void update(const void* data, std::size_t n) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        total_ += n;
+        while (n > 0 && pending_ > 0) {           // finish a partial word
+            buf_[pending_++] = *p++;
+            --n;
+            if (pending_ == 8) { mix(load(buf_)); pending_ = 0; }
+        }
+        for (; n >= 8; n -= 8, p += 8) mix(load(p));
+        while (n-- > 0) buf_[pending_++] = *p++;
+    }
+
+    uint64_t digest() const {
+        uint64_t h = h_;
+        if (pending_ > 0) {
+            unsigned char tail[8] = {};
+            std::memcpy(tail, buf_, pending_);
+            h = (h ^ load(tail)) * kPrime;
+        }
+        h ^= total_;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+private:
+    static constexpr uint64_t kPrime = 0x100000001b3ULL * 0x9E3779B1ULL;
+
+    static uint64_t load(const unsigned char* p) {
+        uint64_t w;
+        std::memcpy(&w, p, 8);
+        return w;
+    }
+    void mix(uint64_t w) {
+        h_ = (h_ ^ w) * kPrime;
+        h_ = (h_ << 29) | (h_ >> 35);
+    }
+
+    uint64_t      h_ = 0xcbf29ce484222325ULL;
+    uint64_t      total_ = 0;
+    unsigned char buf_[8] = {};
+    std::size_t   pending_ = 0;
+};
+
+uint64_t alignUp(uint64_t v) {
+    return (v + kAlign - 1) & ~(kAlign - 1);
+}
+
+template <typename Member>
+using ColumnType = std::remove_reference_t<decltype(std::declval<ServiceRequestOoA&>().*std::declval<Member>())>;
+
+template <typename Col>
+constexpr bool isStringColumn = std::is_same_v<Col, StringColumn>;
+
+template <typename Col>
+constexpr ColumnKind kindOf() {
+    if constexpr (isDictColumn<Col>::value) return kDict;
+    else if constexpr (isStringColumn<Col>) return kString;
+    else if constexpr (isNullableColumn<Col>::value) return kNullable;
+    else return kFixed;
+}
+
+template <typename Col>
+constexpr uint32_t elemSizeOf() {
+    if constexpr (isDictColumn<Col>::value) return sizeof(typename Col::code_type);
+    else if constexpr (isStringColumn<Col>) return sizeof(uint32_t);
+    else return sizeof(typename Col::value_type);
+}
+
+// Fingerprint of the column list; changes whenever a column is added,
+// removed, renamed, reordered or changes type.
+uint64_t schemaHash() {
+    Checksum64 h;
+    forEachColumn([&](const char* name, auto member) {
+        using Col = ColumnType<decltype(member)>;
+        uint32_t kind = kindOf<Col>();
+        uint32_t size = elemSizeOf<Col>();
+        h.update(name, std::strlen(name) + 1);
+        h.update(&kind, sizeof(kind));
+        h.update(&size, sizeof(size));
+    });
+    return h.digest();
+}
+
+// Type-erased view of one column, so the per-column work can run in a
+// plain (OpenMP) loop over the directory.
+struct ColumnRef {
+    const char*               name = nullptr;
+    uint32_t                  kind = kFixed;
+    uint32_t                  elemSize = 0;
+    const void*               raw = nullptr;        // fixed / nullable: values; dict: codes
+    const uint64_t*           validity = nullptr;   // nullable columns
+    StringColumn*             strings = nullptr;    // string columns
+    const std::vector<std::string>* dict = nullptr; // dict columns
+    std::function<void*(std::size_t)> resize;       // fixed: resize, return data()
+    // dict: rebuild the column from raw codes + dictionary
+    std::function<bool(const char*, std::size_t, std::vector<std::string>)> restore;
+    // nullable: rebuild the column from raw values + validity words
+    std::function<bool(const char*, std::size_t)> restoreNullable;
+};
+
+std::vector<ColumnRef> columnRefs(ServiceRequestOoA& data) {
+    std::vector<ColumnRef> refs;
+    forEachColumn([&](const char* name, auto member) {
+        auto& col = data.*member;
+        using Col = ColumnType<decltype(member)>;
+        ColumnRef r;
+        r.name = name;
+        r.kind = kindOf<Col>();
+        r.elemSize = elemSizeOf<Col>();
+        if constexpr (isDictColumn<Col>::value) {
+            using Code = typename Col::code_type;
+            r.raw = col.codes().data();
+            r.dict = &col.dictionary();
+            r.restore = [&col](const char* raw, std::size_t rows, std::vector<std::string> dict) {
+                std::vector<Code> codes(rows);
+                std::memcpy(codes.data(), raw, rows * sizeof(Code));
+                return col.assign(std::move(codes), std::move(dict));
+            };
+        } else if constexpr (isStringColumn<Col>) {
+            r.strings = &col;
+        } else if constexpr (isNullableColumn<Col>::value) {
+            using T = typename Col::value_type;
+            r.raw = col.data();
+            r.validity = col.validity();
+            r.restoreNullable = [&col](const char* raw, std::size_t rows) {
+                std::vector<T> values(rows);
+                std::vector<uint64_t> validity(Col::wordsFor(rows));
+                std::memcpy(values.data(), raw, rows * sizeof(T));
+                std::memcpy(validity.data(), raw + rows * sizeof(T), validity.size() * sizeof(uint64_t));
+                return col.assign(std::move(values), std::move(validity));
+            };
+        } else {
+            r.raw = col.data();
+            r.resize = [&col](std::size_t n) -> void* { col.resize(n); return col.data(); };
+        }
+        refs.push_back(std::move(r));
+    });
+    return refs;
+}
+
+// A string column's region is its in-memory layout: offsets, then heap
+uint64_t stringColumnBytes(const StringColumn& col) {
+    return col.offsets().size() * sizeof(uint32_t) + col.heapBytes();
+}
+
+uint64_t stringColumnChecksum(const StringColumn& col) {
+    Checksum64 h;
+    h.update(col.offsets().data(), col.offsets().size() * sizeof(uint32_t));
+    h.update(col.heap().data(), col.heapBytes());
+    return h.digest();
+}
+
+bool writeAll(std::FILE* f, const void* p, std::size_t n) {
+    return n == 0 || std::fwrite(p, 1, n, f) == n;
+}
+
+bool padTo(std::FILE* f, uint64_t& pos, uint64_t target) {
+    static const char zeros[kAlign] = {};
+    while (pos < target) {
+        std::size_t n = static_cast<std::size_t>(std::min<uint64_t>(kAlign, target - pos));
+        if (!writeAll(f, zeros, n)) return false;
+        pos += n;
+    }
+    return true;
+}
+
+bool writeStringColumn(std::FILE* f, const StringColumn& col) {
+    return writeAll(f, col.offsets().data(), col.offsets().size() * sizeof(uint32_t)) &&
+           writeAll(f, col.heap().data(), col.heapBytes());
+}
+
+// Rebuilds a string column from its offsets + heap region
+bool readStringColumn(const char* region, uint64_t bytes, uint64_t rows, StringColumn& col) {
+    const uint64_t offsetBytes = (rows + 1) * sizeof(uint32_t);
+    std::vector<uint32_t> offsets(static_cast<std::size_t>(rows + 1));   // region may be unaligned for the heap
+    std::memcpy(offsets.data(), region, static_cast<std::size_t>(offsetBytes));
+    return col.assign(offsets.data(), static_cast<std::size_t>(rows), region + offsetBytes,
+                      static_cast<std::size_t>(bytes - offsetBytes));
+}
+
+// Dictionary columns store their codes, then (4-byte aligned) the entry
+// count, uint32 offsets[count + 1] and the entry bytes. The dictionary is
+// tiny, so it is staged in memory.
+uint64_t dictPadding(uint64_t codeBytes) {
+    return (4 - codeBytes % 4) % 4;
+}
+
+std::string dictTail(const std::vector<std::string>& dict, uint64_t codeBytes) {
+    std::string tail(static_cast<std::size_t>(dictPadding(codeBytes)), '\0');
+    auto put = [&tail](uint32_t v) { tail.append(reinterpret_cast<const char*>(&v), sizeof(v)); };
+    put(static_cast<uint32_t>(dict.size()));
+    uint32_t off = 0;
+    put(off);
+    for (const auto& e : dict) put(off += static_cast<uint32_t>(e.size()));
+    for (const auto& e : dict) tail += e;
+    return tail;
+}
+
+bool readDictTail(const char* p, uint64_t bytes, std::vector<std::string>& dict) {
+    if (bytes < sizeof(uint32_t)) return false;
+    uint32_t count;
+    std::memcpy(&count, p, sizeof(count));
+    const uint64_t offsetBytes = (uint64_t(count) + 1) * sizeof(uint32_t);
+    if (bytes - sizeof(uint32_t) < offsetBytes) return false;
+
+    std::vector<uint32_t> offsets(count + 1);
+    std::memcpy(offsets.data(), p + sizeof(uint32_t), static_cast<std::size_t>(offsetBytes));
+    const char* heap = p + sizeof(uint32_t) + offsetBytes;
+    if (offsets[count] != bytes - sizeof(uint32_t) - offsetBytes) return false;
+
+    dict.resize(count);
+    for (uint32_t c = 0; c < count; ++c) {
+        if (offsets[c] > offsets[c + 1]) return false;
+        dict[c].assign(heap + offsets[c], offsets[c + 1] - offsets[c]);
+    }
+    return true;
+}
+
+// Nullable columns store their values, then the validity words
+uint64_t validityBytes(uint64_t rows) {
+    return (rows + 63) / 64 * sizeof(uint64_t);
+}
+
+bool reject(const std::string& path, const char* why) {
+    std::cerr << "[SNAPSHOT] rejected " << path << ": " << why << "\n";
+    return false;
+}
+
+} // namespace
+
+SnapshotSource snapshotSourceOf(const std::string& csvPath, std::size_t maxRecords) {
+    SnapshotSource src;
+    struct stat st {};
+    if (::stat(csvPath.c_str(), &st) == 0) {
+        src.fileSize = static_cast<uint64_t>(st.st_size);
+        src.mtime    = static_cast<int64_t>(st.st_mtime);
+    }
+    src.maxRecords = maxRecords;
+    return src;
+}
+
+bool saveSnapshotOoA(const ServiceRequestOoA& data,
+                     const std::string& path,
+                     const SnapshotSource& source) {
+    if (data.loaded != ColumnSet::all()) {
+        std::cerr << "[SNAPSHOT] not writing " << path << ": columns "
+                  << (ColumnSet::all() - data.loaded).names() << " are not loaded\n";
+        return false;
+    }
+    const uint64_t rows = data.uniqueKey.size();
+    // columnRefs only reads through the refs here; it needs a non-const
+    // object so the same helper can serve the loader
+    std::vector<ColumnRef> refs = columnRefs(const_cast<ServiceRequestOoA&>(data));
+
+    // Directory: sizes and checksums (one column per task)
+    std::vector<SnapshotColumn> dir(refs.size());
+    std::vector<std::string> dictTails(refs.size());
+    const long long C = static_cast<long long>(refs.size());
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (long long c = 0; c < C; ++c) {
+        const ColumnRef& r = refs[static_cast<std::size_t>(c)];
+        SnapshotColumn& d = dir[static_cast<std::size_t>(c)];
+        std::memset(&d, 0, sizeof(d));
+        std::strncpy(d.name, r.name, sizeof(d.name) - 1);
+        d.kind = r.kind;
+        d.elemSize = r.elemSize;
+        if (r.kind == kString) {
+            d.bytes = stringColumnBytes(*r.strings);
+            d.checksum = stringColumnChecksum(*r.strings);
+        } else if (r.kind == kDict) {
+            const uint64_t codeBytes = rows * r.elemSize;
+            std::string& tail = dictTails[static_cast<std::size_t>(c)];
+            tail = dictTail(*r.dict, codeBytes);
+            d.bytes = codeBytes + tail.size();
+            Checksum64 h;
+            h.update(r.raw, static_cast<std::size_t>(codeBytes));
+            h.update(tail.data(), tail.size());
+            d.checksum = h.digest();
+        } else if (r.kind == kNullable) {
+            const uint64_t valueBytes = rows * r.elemSize;
+            d.bytes = valueBytes + validityBytes(rows);
+            Checksum64 h;
+            h.update(r.raw, static_cast<std::size_t>(valueBytes));
+            h.update(r.validity, static_cast<std::size_t>(validityBytes(rows)));
+            d.checksum = h.digest();
+        } else {
+            d.bytes = rows * r.elemSize;
+            Checksum64 h;
+            h.update(r.raw, static_cast<std::size_t>(d.bytes));
+            d.checksum = h.digest();
+        }
+    }
+
+    SnapshotHeader hdr {};
+    std::memcpy(hdr.magic, kMagic, sizeof(kMagic));
+    hdr.version          = kVersion;
+    hdr.endian           = kEndianMarker;
+    hdr.rowCount         = rows;
+    hdr.columnCount      = dir.size();
+    hdr.schemaHash       = schemaHash();
+    hdr.sourceSize       = source.fileSize;
+    hdr.sourceMtime      = source.mtime;
+    hdr.sourceMaxRecords = source.maxRecords;
+
+    uint64_t pos = alignUp(sizeof(hdr) + dir.size() * sizeof(SnapshotColumn));
+    for (auto& d : dir) {
+        d.offset = pos;
+        pos = alignUp(pos + d.bytes);
+    }
+
+    const std::string tmp = path + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) {
+        std::cerr << "[SNAPSHOT] cannot create " << tmp << "\n";
+        return false;
+    }
+    std::vector<char> ioBuf(8u << 20);
+    std::setvbuf(f, ioBuf.data(), _IOFBF, ioBuf.size());
+
+    bool ok = writeAll(f, &hdr, sizeof(hdr)) &&
+              writeAll(f, dir.data(), dir.size() * sizeof(SnapshotColumn));
+    uint64_t written = sizeof(hdr) + dir.size() * sizeof(SnapshotColumn);
+    for (std::size_t c = 0; ok && c < refs.size(); ++c) {
+        ok = padTo(f, written, dir[c].offset);
+        if (!ok) break;
+        if (refs[c].kind == kString)
+            ok = writeStringColumn(f, *refs[c].strings);
+        else if (refs[c].kind == kDict)
+            ok = writeAll(f, refs[c].raw, static_cast<std::size_t>(dir[c].bytes - dictTails[c].size())) &&
+                 writeAll(f, dictTails[c].data(), dictTails[c].size());
+        else if (refs[c].kind == kNullable)
+            ok = writeAll(f, refs[c].raw, static_cast<std::size_t>(rows * dir[c].elemSize)) &&
+                 writeAll(f, refs[c].validity, static_cast<std::size_t>(validityBytes(rows)));
+        else ok = writeAll(f, refs[c].raw, static_cast<std::size_t>(dir[c].bytes));
+        written += dir[c].bytes;
+    }
+    ok = (std::fclose(f) == 0) && ok;
+
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        std::cerr << "[SNAPSHOT] failed writing " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool loadSnapshotOoA(const std::string& path,
+                     ServiceRequestOoA& data,
+                     const SnapshotSource* expected,
+                     const ColumnSet* columns) {
+    data = ServiceRequestOoA{};
+
+    struct stat st {};
+    if (::stat(path.c_str(), &st) != 0) return false;   // no snapshot yet: not an error
+
+    MappedFile file;
+    if (!file.open(path)) return false;
+    const char* base = file.data();
+    const uint64_t fileSize = file.size();
+
+    SnapshotHeader hdr;
+    if (fileSize < sizeof(hdr)) return reject(path, "truncated header");
+    std::memcpy(&hdr, base, sizeof(hdr));
+
+    if (std::memcmp(hdr.magic, kMagic, sizeof(kMagic)) != 0) return reject(path, "not a snapshot");
+    if (hdr.version != kVersion)                              return reject(path, "format version mismatch");
+    if (hdr.endian != kEndianMarker)                          return reject(path, "byte order mismatch");
+    if (hdr.schemaHash != schemaHash())                       return reject(path, "column schema changed");
+    if (expected && (hdr.sourceSize != expected->fileSize ||
+                     hdr.sourceMtime != expected->mtime ||
+                     hdr.sourceMaxRecords != expected->maxRecords))
+        return reject(path, "built from a different CSV or record limit");
+
+    std::vector<ColumnRef> refs = columnRefs(data);
+    if (hdr.columnCount != refs.size()) return reject(path, "column count mismatch");
+
+    const uint64_t dirBytes = hdr.columnCount * sizeof(SnapshotColumn);
+    if (fileSize < sizeof(hdr) + dirBytes) return reject(path, "truncated directory");
+    std::vector<SnapshotColumn> dir(refs.size());
+    std::memcpy(dir.data(), base + sizeof(hdr), static_cast<std::size_t>(dirBytes));
+
+    const uint64_t rows = hdr.rowCount;
+    for (std::size_t c = 0; c < refs.size(); ++c) {
+        const SnapshotColumn& d = dir[c];
+        if (std::strncmp(d.name, refs[c].name, sizeof(d.name)) != 0 || d.kind != refs[c].kind ||
+            d.elemSize != refs[c].elemSize)
+            return reject(path, "column directory mismatch");
+        if (d.offset > fileSize || d.bytes > fileSize - d.offset)
+            return reject(path, "column region out of bounds");
+        uint64_t minBytes = rows * d.elemSize;
+        if (d.kind == kString) minBytes = (rows + 1) * d.elemSize;
+        if (d.kind == kDict)   minBytes += dictPadding(minBytes) + 2 * sizeof(uint32_t);
+        if (d.kind == kNullable) minBytes += validityBytes(rows);
+        if (d.kind == kFixed || d.kind == kNullable ? d.bytes != minBytes : d.bytes < minBytes)
+            return reject(path, "column size mismatch");
+    }
+
+    // Verify and materialize the requested columns, one column per task.
+    // Fixed-width columns are a single memcpy; dict columns copy their codes
+    // and decode the small dictionary; nullable columns copy their values and
+    // validity words; string columns copy their offsets and heap. The other
+    // regions are never touched, so they are never read.
+    const ColumnSet want = columns ? (*columns | ColumnSet{Column::uniqueKey}) : ColumnSet::all();
+    int failed = 0;
+    const long long C = static_cast<long long>(refs.size());
+    #pragma omp parallel for schedule(dynamic, 1) reduction(|:failed)
+    for (long long c = 0; c < C; ++c) {
+        if (!want.has(static_cast<std::size_t>(c))) continue;
+        const SnapshotColumn& d = dir[static_cast<std::size_t>(c)];
+        ColumnRef& r = refs[static_cast<std::size_t>(c)];
+        const char* region = base + d.offset;
+
+        Checksum64 h;
+        h.update(region, static_cast<std::size_t>(d.bytes));
+        if (h.digest() != d.checksum) { failed = 1; continue; }
+
+        if (r.kind == kFixed) {
+            std::memcpy(r.resize(static_cast<std::size_t>(rows)), region, static_cast<std::size_t>(d.bytes));
+            continue;
+        }
+
+        if (r.kind == kNullable) {
+            if (!r.restoreNullable(region, static_cast<std::size_t>(rows))) failed = 1;
+            continue;
+        }
+
+        if (r.kind == kDict) {
+            const uint64_t codeBytes = rows * d.elemSize;
+            const uint64_t pad = dictPadding(codeBytes);
+            std::vector<std::string> dict;
+            if (!readDictTail(region + codeBytes + pad, d.bytes - codeBytes - pad, dict) ||
+                !r.restore(region, static_cast<std::size_t>(rows), std::move(dict)))
+                failed = 1;
+            continue;
+        }
+
+        if (!readStringColumn(region, d.bytes, rows, *r.strings)) failed = 1;
+    }
+
+    if (failed) {
+        data = ServiceRequestOoA{};
+        return reject(path, "column checksum mismatch");
+    }
+    data.loaded = want;
+    data.origin = ColumnOrigin{path, true, static_cast<std::size_t>(hdr.sourceMaxRecords), IngestMode::Pipelined};
+    return true;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "ServiceRequest.h"
+#include <cstdint>
+#include <string>
+
+// ---------------------------------------------------------------------------
+// Binary columnar snapshot of ServiceRequestOoA
+//
+//   Parsing the CSV takes minutes; a snapshot reloads the same columns with
+//   almost no parsing. Layout (little-endian, every region 64-byte aligned):
+//
+//     SnapshotHeader
+//     SnapshotColumn[columnCount]     directory, in forEachColumn() order
+//     column regions:
+//       fixed-width column : raw values (rowCount * elemSize bytes)
+//       nullable column    : raw values, then the validity bitmap
+//                            (uint64 words, one bit per row)
+//       dict column        : codes[rowCount], then the entry count,
+//                            uint32 offsets[count + 1] and entry bytes
+//       string column      : uint32 offsets[rowCount + 1], then byte heap
+//                            (the StringColumn layout, copied as is)
+//
+//   A snapshot is rejected (load returns false) when the magic, format
+//   version, schema fingerprint (column names/types) or any per-column
+//   checksum does not match, or when it was built from a different CSV
+//   (size / mtime) or record limit than the caller expects.
+// ---------------------------------------------------------------------------
+
+// Identifies the CSV (and record cap) a snapshot was built from
+struct SnapshotSource {
+    uint64_t fileSize   = 0;
+    int64_t  mtime      = 0;
+    uint64_t maxRecords = 0;
+};
+
+// stat()s the CSV; returns a zeroed source if the file does not exist
+SnapshotSource snapshotSourceOf(const std::string& csvPath, std::size_t maxRecords);
+
+// Writes `data` to `path` (via a temporary file + rename). Every column must
+// be loaded. Returns false on a projected load or an I/O error.
+bool saveSnapshotOoA(const ServiceRequestOoA& data,
+                     const std::string& path,
+                     const SnapshotSource& source);
+
+// Maps `path` and fills `data`. When `expected` is given, the snapshot must
+// have been built from that source. `columns` projects the load (uniqueKey
+// always comes along); the other columns are read later by ensureColumns().
+// Returns false (and prints why) if the snapshot is missing, stale or
+// corrupt; `data` is then left empty.
+bool loadSnapshotOoA(const std::string& path,
+                     ServiceRequestOoA& data,
+                     const SnapshotSource* expected = nullptr,
+                     const ColumnSet* columns = nullptr);
@@ -0,0 +1,79 @@
+#include "SortedIndex.h"
+#include "../common/RowOrder.h"
+#include "../common/ThreadPool.h"
+
+#include <algorithm>
+
+void SortedIndex::build(const std::vector<uint32_t>& keys) {
+    const std::size_t n = keys.size();
+    const std::size_t M = ThreadPool::morselCount(n);
+    ThreadPool& pool = ThreadPool::global();
+
+    perm_.resize(n);
+    for (std::size_t i = 0; i < n; ++i) perm_[i] = static_cast<uint32_t>(i);
+    if (n < 2) return;
+
+    // Sorting (key, row) packed as key << 32 | row keeps ties in row order
+    std::vector<uint64_t> cur(n), tmp(n);
+    pool.forEachMorsel(n, [&](const ThreadPool::Morsel& m, unsigned) {
+        for (std::size_t i = m.begin; i < m.end; ++i) cur[i] = (uint64_t(keys[i]) << 32) | i;
+    });
+
+    std::vector<std::size_t> cursor(M * 256);
+    for (int shift = 32; shift < 64; shift += 8) {
+        // Per-morsel histograms of this byte
+        std::fill(cursor.begin(), cursor.end(), 0);
+        pool.forEachMorsel(n, [&](const ThreadPool::Morsel& m, unsigned) {
+            std::size_t* h = cursor.data() + m.index * 256;
+            for (std::size_t i = m.begin; i < m.end; ++i) h[(cur[i] >> shift) & 0xff]++;
+        });
+
+        // One bucket holds everything: this byte is constant, skip the pass
+        bool constant = false;
+        for (std::size_t b = 0; b < 256 && !constant; ++b) {
+            std::size_t total = 0;
+            for (std::size_t m = 0; m < M; ++m) total += cursor[m * 256 + b];
+            constant = total == n;
+        }
+        if (constant) continue;
+
+        // Bucket-major prefix sum keeps the scatter stable across morsels
+        std::size_t total = 0;
+        for (std::size_t b = 0; b < 256; ++b)
+            for (std::size_t m = 0; m < M; ++m) {
+                const std::size_t count = cursor[m * 256 + b];
+                cursor[m * 256 + b] = total;
+                total += count;
+            }
+
+        pool.forEachMorsel(n, [&](const ThreadPool::Morsel& m, unsigned) {
+            std::size_t* pos = cursor.data() + m.index * 256;
+            for (std::size_t i = m.begin; i < m.end; ++i) tmp[pos[(cur[i] >> shift) & 0xff]++] = cur[i];
+        });
+        cur.swap(tmp);
+    }
+
+    pool.forEachMorsel(n, [&](const ThreadPool::Morsel& m, unsigned) {
+        for (std::size_t i = m.begin; i < m.end; ++i) perm_[i] = static_cast<uint32_t>(cur[i]);
+    });
+}
+
+SortedIndex::Span SortedIndex::range(const std::vector<uint32_t>& keys, uint32_t lo, uint32_t hi) const {
+    Span s;
+    s.first = s.last = perm_.data();
+    if (lo > hi || perm_.empty()) return s;
+    const uint32_t* k = keys.data();
+    s.first = std::lower_bound(perm_.data(), perm_.data() + perm_.size(), lo,
+                               [k](uint32_t row, uint32_t key) { return k[row] < key; });
+    s.last = std::upper_bound(s.first, perm_.data() + perm_.size(), hi,
+                              [k](uint32_t key, uint32_t row) { return key < k[row]; });
+    return s;
+}
+
+// Rows of the span in ascending row order (see sortRowIds)
+std::vector<std::size_t> SortedIndex::rowsInRange(const std::vector<uint32_t>& keys, uint32_t lo, uint32_t hi) const {
+    const Span s = range(keys, lo, hi);
+    std::vector<std::size_t> out(s.begin(), s.end());
+    sortRowIds(out, perm_.size());
+    return out;
+}
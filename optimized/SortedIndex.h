@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// SortedIndex
+//   Permutation index over a uint32_t column (e.g. the packed createdDate
+//   keys): row ids ordered by key, ties in row order. A key range resolves
+//   to a contiguous span of the permutation with two binary searches, so a
+//   one-day range costs O(log n) plus its matches instead of a column scan.
+//
+//   Built with a stable LSD radix sort on the thread pool (one pass per
+//   key byte; bytes that are equal across the whole column are skipped).
+//   4 bytes per row; rebuild it if the column changes.
+// ---------------------------------------------------------------------------
+class SortedIndex {
+public:
+    // Row ids whose key is in the range, in key order
+    struct Span {
+        const uint32_t* first = nullptr;
+        const uint32_t* last = nullptr;
+
+        const uint32_t* begin() const { return first; }
+        const uint32_t* end() const { return last; }
+        std::size_t size() const { return static_cast<std::size_t>(last - first); }
+        bool empty() const { return first == last; }
+    };
+
+    void build(const std::vector<uint32_t>& keys);
+
+    // Rows with lo <= key <= hi. `keys` must be the column the index was
+    // built from.
+    Span range(const std::vector<uint32_t>& keys, uint32_t lo, uint32_t hi) const;
+
+    // Same rows as range(), as ascending row ids (what a scan returns)
+    std::vector<std::size_t> rowsInRange(const std::vector<uint32_t>& keys, uint32_t lo, uint32_t hi) const;
+
+    std::size_t size() const { return perm_.size(); }
+    std::size_t memoryBytes() const { return perm_.capacity() * sizeof(uint32_t); }
+
+private:
+    std::vector<uint32_t> perm_;   // row ids ordered by (key, row)
+};
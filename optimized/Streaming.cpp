@@ -0,0 +1,138 @@
+#include "Streaming.h"
+#include "ServiceRequest.h"
+#include "queries.h"
+#include "../common/MemStats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+// Rows of the first batch, used to measure column bytes per row
+static constexpr std::size_t kProbeRows = std::size_t(1) << 16;
+
+// What Queries 1-4 keep across batches
+struct StreamMatches {
+    const char* label;
+    std::vector<uint64_t> rows;       // global row numbers, ascending
+    std::vector<uint64_t> sampleKeys; // uniqueKey of the first matches
+};
+
+// Appends one batch's matches (batch-local indices) as global row numbers
+static void addMatches(StreamMatches& m, const std::vector<std::size_t>& local, std::size_t batchStart,
+                       const ServiceRequestOoA& batch, std::size_t sampleN) {
+    for (std::size_t idx : local) {
+        if (m.sampleKeys.size() < sampleN) m.sampleKeys.push_back(batch.uniqueKey[idx]);
+        m.rows.push_back(batchStart + idx);
+    }
+}
+
+static void mergeZones(std::unordered_map<std::string, ZoneStatsOoA>& into,
+                       const std::unordered_map<std::string, ZoneStatsOoA>& from) {
+    for (const auto& kv : from) {
+        ZoneStatsOoA& z = into[kv.first];
+        z.totalCount += kv.second.totalCount;
+        for (const auto& c : kv.second.byComplaintType) z.byComplaintType[c.first] += c.second;
+    }
+}
+
+static std::size_t columnBytesOf(const ServiceRequestOoA& data) {
+    std::size_t total = 0;
+    for (const auto& c : columnMemoryOoA(data)) total += c.bytes;
+    return total;
+}
+
+bool runStreamingQueries(const std::string& filename, std::size_t budgetBytes,
+                         const StreamQueryParams& params, std::size_t sampleN) {
+    using clock = std::chrono::high_resolution_clock;
+    const double mb = 1024.0 * 1024.0;
+
+    // Batches hold only the columns the six queries read
+    BatchReaderOoA reader;
+    if (!reader.open(filename, {Column::uniqueKey, Column::createdDate, Column::boroughUpper,
+                                Column::complaintType, Column::latitude, Column::longitude}))
+        return false;
+
+    StreamMatches matches[4] = {
+        {"[Query 1] date range", {}, {}},
+        {"[Query 2] borough filter", {}, {}},
+        {"[Query 3] complaint search", {}, {}},
+        {"[Query 4] lat/lon box", {}, {}},
+    };
+    double latSum = 0.0;
+    std::size_t latRows = 0;   // non-null latitudes
+    std::unordered_map<std::string, ZoneStatsOoA> zones;
+
+    ServiceRequestOoA batch;
+    std::size_t batchRows = kProbeRows;
+    std::size_t batches = 0;
+    std::size_t totalRows = 0;
+    double loadSeconds = 0.0, querySeconds = 0.0;
+
+    std::cout << "[STREAM] file=\"" << filename << "\" budget=" << budgetBytes / mb << " MB\n";
+
+    for (;;) {
+        auto loadStart = clock::now();
+        if (!reader.next(batch, batchRows)) {
+            std::cerr << "Error: failed to load batch " << batches + 1 << "\n";
+            return false;
+        }
+        loadSeconds += std::chrono::duration<double>(clock::now() - loadStart).count();
+        const std::size_t n = batch.uniqueKey.size();
+        if (n == 0) break;
+
+        auto queryStart = clock::now();
+        const std::size_t base = reader.batchStart();
+        addMatches(matches[0], filterByCreatedDateRangeOoA_omp(batch, params.startKey, params.endKey),
+                   base, batch, sampleN);
+        addMatches(matches[1], filterByBoroughOoA_omp(batch, params.borough), base, batch, sampleN);
+        addMatches(matches[2], searchByComplaintOoA(batch, params.keyword), base, batch, sampleN);
+        addMatches(matches[3], filterByLatLonBoxOoA(batch, params.minLat, params.maxLat,
+                                                    params.minLon, params.maxLon),
+                   base, batch, sampleN);
+        const std::size_t latValid = n - batch.latitude.nullCount();
+        latSum += averageLatitudeOoA_omp(batch) * static_cast<double>(latValid);
+        latRows += latValid;
+        mergeZones(zones, aggregateByBoroughOoA_omp_fast(batch));
+        querySeconds += std::chrono::duration<double>(clock::now() - queryStart).count();
+
+        ++batches;
+        totalRows += n;
+        const std::size_t columnBytes = columnBytesOf(batch);
+        std::cout << "[STREAM] batch " << batches << ": rows " << base << "-" << base + n - 1
+                  << " (" << 100.0 * reader.progress() << "%), columns=" << columnBytes / mb
+                  << " MB, rss=" << rssMemMB() << " MB\n";
+
+        // Size the remaining batches from what the probe batch took per row
+        if (batches == 1) {
+            const double bytesPerRow = static_cast<double>(columnBytes) / static_cast<double>(n);
+            batchRows = std::max(kProbeRows, static_cast<std::size_t>(budgetBytes / bytesPerRow));
+            std::cout << "[STREAM] " << bytesPerRow << " column bytes/row -> " << batchRows
+                      << " rows per batch\n";
+        }
+    }
+
+    std::size_t resultBytes = 0;
+    for (const auto& m : matches) resultBytes += allocatedBytes(m.rows);
+    const MemStats mem = readMemStats();
+    std::cout << "[STREAM] " << totalRows << " rows in " << batches << " batches, load=" << loadSeconds
+              << "s, queries=" << querySeconds << "s, results=" << resultBytes / mb
+              << " MB, peak rss=" << mem.peakRss / mb << " MB\n";
+
+    std::cout << "\nQuery Outputs (streamed)\n";
+    for (const auto& m : matches) {
+        std::cout << "\n" << m.label << " -> size=" << m.rows.size() << "\n";
+        if (sampleN == 0) continue;
+        std::cout << "  Results - (" << m.sampleKeys.size() << "/" << m.rows.size() << "):\n";
+        for (std::size_t i = 0; i < m.sampleKeys.size(); ++i)
+            std::cout << "    [" << i << "] row=" << m.rows[i] << " key=" << m.sampleKeys[i] << "\n";
+    }
+
+    std::cout << "\n[Query 5] average latitude -> value="
+              << (latRows ? latSum / static_cast<double>(latRows) : 0.0) << "\n";
+
+    std::cout << "\n[Query 6] borough aggregation\n";
+    printTopComplaintPerBorough(zones);
+    return true;
+}
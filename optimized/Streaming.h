@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// ---------------------------------------------------------------------------
+// Streaming (out-of-core) execution of the six queries
+//
+//   For files that do not fit in memory (the full 311_combined.csv is
+//   ~20M rows / 12 GB, beyond the 14M-row cap of the in-memory load). The
+//   CSV is read in row batches by BatchReaderOoA; each batch runs Queries
+//   1-6 on the pool and is dropped. Only what the answers need stays
+//   resident:
+//
+//     Queries 1-4   global row numbers of the matches (8 bytes per match)
+//                   plus the first few matches' keys for the sample
+//     Query 5       latitude sum and non-null count
+//     Query 6       per-borough totals and complaint histograms
+//
+//   Batches are projected onto the six columns the queries read. The batch
+//   size is picked from the memory budget and the column bytes per row
+//   measured on a first, small batch. The budget bounds the batch's
+//   columns; the result indices come on top and are reported at the end.
+//   Row numbers and answers equal the in-memory load of the same rows.
+// ---------------------------------------------------------------------------
+
+// Parameters of the six queries, as in the in-memory run
+struct StreamQueryParams {
+    uint32_t    startKey = 0;      // Query 1: createdDate range (parseDateKey)
+    uint32_t    endKey = 0;
+    std::string borough;           // Query 2: uppercase borough name
+    std::string keyword;           // Query 3: complaint substring
+    double      minLat = 0, maxLat = 0, minLon = 0, maxLon = 0;   // Query 4
+};
+
+// Runs the six queries over `filename` batch by batch and prints the
+// answers. Returns false if the file cannot be read or a batch fails to load.
+bool runStreamingQueries(const std::string& filename, std::size_t budgetBytes,
+                         const StreamQueryParams& params, std::size_t sampleN);
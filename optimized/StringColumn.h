@@ -0,0 +1,84 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+#include "../common/MemStats.h"
+
+// Arena-backed column for free-text fields (descriptor, incidentAddress,
+// resolutionDescription, ...). All values sit back to back in one byte
+// heap; row i is heap[offsets[i], offsets[i + 1]). Compared with a
+// vector<string> that is one allocation instead of one per long value, no
+// 32-byte string header per row, and a text scan walks memory in order.
+//
+// Reads return std::string_view into the heap: valid until the column is
+// next modified. The layout (uint32 offsets[rows + 1], then the heap) is
+// what snapshots store, so saving and loading are plain copies.
+class StringColumn {
+public:
+   using value_type = std::string_view;
+
+   // Largest heap a column can address with 32-bit offsets
+   static constexpr std::size_t kMaxBytes = std::numeric_limits<uint32_t>::max();
+
+   StringColumn() { offsets_.push_back(0); }
+
+   std::size_t size() const { return offsets_.size() - 1; }
+   bool empty() const { return size() == 0; }
+   // Reserves offsets for `rows` rows (the heap grows on demand)
+   void reserve(std::size_t rows) { offsets_.reserve(rows + 1); }
+   void reserveBytes(std::size_t bytes) { heap_.reserve(bytes); }
+
+   std::string_view operator[](std::size_t i) const {
+      return std::string_view(heap_.data() + offsets_[i], offsets_[i + 1] - offsets_[i]);
+   }
+
+   const std::vector<uint32_t>& offsets() const { return offsets_; }
+   const std::vector<char>& heap() const { return heap_; }
+   std::size_t heapBytes() const { return heap_.size(); }
+
+   std::size_t memoryBytes() const { return allocatedBytes(offsets_) + allocatedBytes(heap_); }
+
+   // Appends one row. Returns false (and appends nothing) if the heap would
+   // pass kMaxBytes.
+   bool push_back(std::string_view v) {
+      if (v.size() > kMaxBytes - heap_.size()) return false;
+      heap_.insert(heap_.end(), v.begin(), v.end());
+      offsets_.push_back(static_cast<uint32_t>(heap_.size()));
+      return true;
+   }
+
+   // Appends the first `count` rows of another column: one copy of their
+   // bytes plus rebased offsets. Returns false (appending nothing) on
+   // heap overflow.
+   bool append(const StringColumn& other, std::size_t count) {
+      const uint32_t bytes = other.offsets_[count];
+      if (bytes > kMaxBytes - heap_.size()) return false;
+      const uint32_t base = static_cast<uint32_t>(heap_.size());
+      heap_.insert(heap_.end(), other.heap_.begin(), other.heap_.begin() + bytes);
+      for (std::size_t i = 1; i <= count; ++i) offsets_.push_back(base + other.offsets_[i]);
+      return true;
+   }
+
+   void clear() {
+      offsets_.resize(1);
+      heap_.clear();
+   }
+
+   // Bulk restore (snapshot load). offsets must start at 0, never decrease
+   // and end at `bytes`.
+   bool assign(const uint32_t* offsets, std::size_t rows, const char* heap, std::size_t bytes) {
+      if (offsets[0] != 0 || offsets[rows] != bytes) return false;
+      for (std::size_t i = 0; i < rows; ++i)
+         if (offsets[i] > offsets[i + 1]) return false;
+      offsets_.assign(offsets, offsets + rows + 1);
+      heap_.assign(heap, heap + bytes);
+      return true;
+   }
+
+private:
+   std::vector<uint32_t> offsets_;   // rows + 1 entries, offsets_[0] == 0
+   std::vector<char> heap_;
+};
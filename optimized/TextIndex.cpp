@@ -0,0 +1,181 @@
+#include "TextIndex.h"
+#include "../common/ThreadPool.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+
+static std::string toLower(std::string_view s) {
+    std::string out(s);
+    for (auto& c : out) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return out;
+}
+
+static inline uint32_t gramAt(const std::string& s, std::size_t i) {
+    return (uint32_t(static_cast<unsigned char>(s[i])) << 16) |
+           (uint32_t(static_cast<unsigned char>(s[i + 1])) << 8) |
+            uint32_t(static_cast<unsigned char>(s[i + 2]));
+}
+
+// ----------------------------------------------------------------------------
+// TrigramIndex
+// ----------------------------------------------------------------------------
+
+void TrigramIndex::build(const std::vector<std::string>& dict) {
+    lower_.clear();
+    grams_.clear();
+    lower_.reserve(dict.size());
+    for (std::size_t c = 0; c < dict.size(); ++c) {
+        lower_.push_back(toLower(dict[c]));
+        const std::string& s = lower_.back();
+        for (std::size_t i = 0; i + 3 <= s.size(); ++i) {
+            // codes arrive in ascending order; skip a repeat within one value
+            std::vector<uint32_t>& list = grams_[gramAt(s, i)];
+            if (list.empty() || list.back() != c) list.push_back(static_cast<uint32_t>(c));
+        }
+    }
+}
+
+std::vector<uint32_t> TrigramIndex::match(std::string_view keyword) const {
+    const std::string key = toLower(keyword);
+    std::vector<uint32_t> out;
+
+    // Too short to have a trigram: check every value
+    if (key.size() < 3) {
+        for (std::size_t c = 0; c < lower_.size(); ++c)
+            if (lower_[c].find(key) != std::string::npos) out.push_back(static_cast<uint32_t>(c));
+        return out;
+    }
+
+    // Posting lists of the keyword's trigrams, shortest first
+    std::vector<const std::vector<uint32_t>*> lists;
+    for (std::size_t i = 0; i + 3 <= key.size(); ++i) {
+        auto it = grams_.find(gramAt(key, i));
+        if (it == grams_.end()) return out;          // a trigram no value has
+        lists.push_back(&it->second);
+    }
+    std::sort(lists.begin(), lists.end(),
+              [](const auto* a, const auto* b) { return a->size() < b->size(); });
+
+    std::vector<uint32_t> candidates = *lists[0];
+    std::vector<uint32_t> next;
+    for (std::size_t l = 1; l < lists.size() && !candidates.empty(); ++l) {
+        next.clear();
+        std::set_intersection(candidates.begin(), candidates.end(),
+                              lists[l]->begin(), lists[l]->end(), std::back_inserter(next));
+        candidates.swap(next);
+    }
+
+    // Having every trigram does not mean they are adjacent; confirm
+    for (uint32_t c : candidates)
+        if (lower_[c].find(key) != std::string::npos) out.push_back(c);
+    return out;
+}
+
+std::size_t TrigramIndex::memoryBytes() const {
+    std::size_t bytes = lower_.capacity() * sizeof(std::string);
+    for (const auto& s : lower_) bytes += s.capacity();
+    for (const auto& g : grams_) bytes += sizeof(g) + g.second.capacity() * sizeof(uint32_t);
+    return bytes;
+}
+
+// ----------------------------------------------------------------------------
+// PostingLists
+// ----------------------------------------------------------------------------
+
+void PostingLists::build(const std::vector<uint8_t>& codes, std::size_t distinct) { buildImpl(codes, distinct); }
+void PostingLists::build(const std::vector<uint16_t>& codes, std::size_t distinct) { buildImpl(codes, distinct); }
+
+template <typename Code>
+void PostingLists::buildImpl(const std::vector<Code>& codes, std::size_t distinct) {
+    const std::size_t n = codes.size();
+    const std::size_t K = distinct;
+    const std::size_t M = ThreadPool::morselCount(n);
+    ThreadPool& pool = ThreadPool::global();
+
+    // Pass 1: per-morsel histograms
+    std::vector<std::size_t> cursor(M * K, 0);
+    pool.forEachMorsel(n, [&](const ThreadPool::Morsel& m, unsigned) {
+        std::size_t* h = cursor.data() + m.index * K;
+        for (std::size_t i = m.begin; i < m.end; ++i) h[codes[i]]++;
+    });
+
+    // Code-major prefix sum: morsel m's rows of code c land after those of
+    // morsels < m, so every list comes out in row order
+    offsets_.assign(K + 1, 0);
+    std::size_t total = 0;
+    for (std::size_t c = 0; c < K; ++c) {
+        offsets_[c] = total;
+        for (std::size_t m = 0; m < M; ++m) {
+            const std::size_t count = cursor[m * K + c];
+            cursor[m * K + c] = total;
+            total += count;
+        }
+    }
+    offsets_[K] = total;
+
+    // Pass 2: scatter
+    rows_.assign(n, 0);
+    pool.forEachMorsel(n, [&](const ThreadPool::Morsel& m, unsigned) {
+        std::size_t* pos = cursor.data() + m.index * K;
+        for (std::size_t i = m.begin; i < m.end; ++i) rows_[pos[codes[i]]++] = static_cast<uint32_t>(i);
+    });
+}
+
+// The rows of code c that fall in [begin, end)
+static inline std::pair<const uint32_t*, const uint32_t*>
+clip(const uint32_t* first, const uint32_t* last, std::size_t begin, std::size_t end) {
+    const uint32_t* lo = std::lower_bound(first, last, begin);
+    const uint32_t* hi = std::lower_bound(lo, last, end);
+    return {lo, hi};
+}
+
+// Per morsel (whole 64-bit words): clip every code's list to the morsel and
+// OR its rows into the morsel's words
+static void markMorsel(const PostingLists& p, const std::vector<uint32_t>& codes,
+                       std::size_t begin, std::size_t end, uint64_t* words) {
+    for (uint32_t c : codes) {
+        auto range = clip(p.begin(c), p.end(c), begin, end);
+        for (const uint32_t* r = range.first; r != range.second; ++r)
+            words[(*r - begin) / 64] |= uint64_t(1) << (*r % 64);
+    }
+}
+
+std::vector<std::size_t> PostingLists::rowsOf(const std::vector<uint32_t>& codes) const {
+    std::vector<std::size_t> out;
+    if (codes.empty() || rows_.empty()) return out;
+
+    // One list is already the answer
+    if (codes.size() == 1) {
+        const uint32_t c = codes[0];
+        out.resize(count(c));
+        const uint32_t* src = begin(c);
+        ThreadPool::global().forEachMorsel(out.size(), [&](const ThreadPool::Morsel& m, unsigned) {
+            for (std::size_t i = m.begin; i < m.end; ++i) out[i] = src[i];
+        });
+        return out;
+    }
+
+    // Several lists: merge per row morsel through a small local bitmap, so
+    // the output comes out in row order without a sort
+    return ThreadPool::global().select(rows_.size(),
+        [&](std::size_t begin, std::size_t end, std::size_t* dst) {
+            uint64_t words[ThreadPool::kMorselRows / 64] = {};
+            markMorsel(*this, codes, begin, end, words);
+            std::size_t n = 0;
+            for (std::size_t w = 0; w < (end - begin + 63) / 64; ++w)
+                for (uint64_t bits = words[w]; bits != 0; bits &= bits - 1)
+                    dst[n++] = begin + w * 64 + static_cast<std::size_t>(__builtin_ctzll(bits));
+            return n;
+        });
+}
+
+RowBitmap PostingLists::bitmapOf(const std::vector<uint32_t>& codes) const {
+    RowBitmap bm(rows_.size());
+    if (codes.empty()) return bm;
+    uint64_t* words = bm.words();
+    ThreadPool::global().forEachMorsel(rows_.size(), [&](const ThreadPool::Morsel& m, unsigned) {
+        markMorsel(*this, codes, m.begin, m.end, words + m.begin / 64);
+    });
+    return bm;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "DictColumn.h"
+#include "RowBitmap.h"
+
+// ---------------------------------------------------------------------------
+// TrigramIndex
+//   Case-insensitive substring search over the distinct values of a
+//   dictionary column. Every lowercased value is cut into byte trigrams and
+//   each trigram maps to the ascending codes that contain it. A keyword of
+//   3+ bytes intersects the lists of its own trigrams and verifies the few
+//   survivors with find(); shorter keywords just check every value.
+// ---------------------------------------------------------------------------
+class TrigramIndex {
+public:
+    void build(const std::vector<std::string>& dict);
+
+    // Ascending codes whose value contains `keyword` (ignoring case). An
+    // empty keyword matches every code, including 0 ("").
+    std::vector<uint32_t> match(std::string_view keyword) const;
+
+    std::size_t gramCount() const { return grams_.size(); }
+    std::size_t memoryBytes() const;
+
+private:
+    std::vector<std::string> lower_;                              // lowercased dictionary
+    std::unordered_map<uint32_t, std::vector<uint32_t>> grams_;   // trigram -> codes
+};
+
+// ---------------------------------------------------------------------------
+// PostingLists
+//   Ascending row ids of every code of a dictionary column, stored CSR-style:
+//   rows(c) is rows_[offsets_[c] .. offsets_[c + 1]). Built with a parallel
+//   counting sort (per-morsel histograms, then a scatter), so lists stay in
+//   row order. 4 bytes per row.
+// ---------------------------------------------------------------------------
+class PostingLists {
+public:
+    void build(const std::vector<uint8_t>& codes, std::size_t distinct);
+    void build(const std::vector<uint16_t>& codes, std::size_t distinct);
+
+    std::size_t rowCount() const { return rows_.size(); }
+    const uint32_t* begin(uint32_t code) const { return rows_.data() + offsets_[code]; }
+    const uint32_t* end(uint32_t code) const { return rows_.data() + offsets_[code + 1]; }
+    std::size_t count(uint32_t code) const { return offsets_[code + 1] - offsets_[code]; }
+
+    std::size_t memoryBytes() const {
+        return offsets_.capacity() * sizeof(std::size_t) + rows_.capacity() * sizeof(uint32_t);
+    }
+
+    // Ascending rows of all `codes` (given ascending), merged in row order
+    std::vector<std::size_t> rowsOf(const std::vector<uint32_t>& codes) const;
+    RowBitmap bitmapOf(const std::vector<uint32_t>& codes) const;
+
+private:
+    template <typename Code>
+    void buildImpl(const std::vector<Code>& codes, std::size_t distinct);
+
+    std::vector<std::size_t> offsets_;   // distinct + 1 entries
+    std::vector<uint32_t>    rows_;
+};
+
+// ---------------------------------------------------------------------------
+// TextIndex
+//   Substring search engine for one dictionary column: the keyword resolves
+//   to matching codes through the trigram index, and the result is read from
+//   their posting lists. A query touches only the matching rows instead of
+//   scanning the whole column. Rebuild it if the column changes.
+// ---------------------------------------------------------------------------
+class TextIndex {
+public:
+    template <typename Code>
+    void build(const DictColumn<Code>& column) {
+        grams_.build(column.dictionary());
+        postings_.build(column.codes(), column.dictionary().size());
+    }
+
+    std::vector<uint32_t> matchCodes(std::string_view keyword) const { return grams_.match(keyword); }
+
+    // Ascending row ids whose value contains `keyword` (ignoring case)
+    std::vector<std::size_t> search(std::string_view keyword) const {
+        return postings_.rowsOf(grams_.match(keyword));
+    }
+    RowBitmap searchBitmap(std::string_view keyword) const {
+        return postings_.bitmapOf(grams_.match(keyword));
+    }
+
+    std::size_t rowCount() const { return postings_.rowCount(); }
+    std::size_t gramCount() const { return grams_.gramCount(); }
+    std::size_t memoryBytes() const { return grams_.memoryBytes() + postings_.memoryBytes(); }
+
+private:
+    TrigramIndex grams_;
+    PostingLists postings_;
+};
@@ -0,0 +1,87 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "NullableColumn.h"
+#include "../common/ThreadPool.h"
+
+// ---------------------------------------------------------------------------
+// ZoneMap<T>
+//   Per-block metadata for a numeric or date column: min / max of the
+//   non-null values and the null count of every 64K-row block. A range
+//   filter asks each block first. mayMatch() == false skips the block
+//   unread, and allMatch() == true takes it whole without comparing a row.
+//
+//   Blocks are exactly the thread pool's morsels (same size, same
+//   alignment), so a select kernel's `begin / kBlockRows` is its block.
+//   The column's validity bitmap says which rows are null; nulls and NaN
+//   never match.
+// ---------------------------------------------------------------------------
+template <typename T>
+class ZoneMap {
+    static_assert(std::is_arithmetic<T>::value, "zone maps are for numeric columns");
+
+public:
+    static constexpr std::size_t kBlockRows = ThreadPool::kMorselRows;
+
+    struct Zone {
+        T min{}, max{};           // over the non-null values; unset if valueCount == 0
+        uint32_t valueCount = 0;  // rows that are neither null nor NaN
+        uint32_t nullCount = 0;   // null rows
+        uint32_t rows = 0;
+    };
+
+    void build(const NullableColumn<T>& column) {
+        const T* v = column.data();
+        const uint64_t* validity = column.hasNulls() ? column.validity() : nullptr;
+        zones_.assign(ThreadPool::morselCount(column.size(), kBlockRows), Zone{});
+        ThreadPool::global().forEachMorsel(column.size(), [&](const ThreadPool::Morsel& m, unsigned) {
+            Zone z;
+            z.rows = static_cast<uint32_t>(m.end - m.begin);
+            for (std::size_t i = m.begin; i < m.end; ++i) {
+                const T x = v[i];
+                if (validity && !((validity[i / 64] >> (i % 64)) & 1)) { z.nullCount++; continue; }
+                if (isNaN(x)) continue;
+                if (z.valueCount++ == 0) { z.min = z.max = x; continue; }
+                if (x < z.min) z.min = x;
+                if (x > z.max) z.max = x;
+            }
+            zones_[m.index] = z;
+        }, kBlockRows);
+    }
+
+    std::size_t blockCount() const { return zones_.size(); }
+    const Zone& zone(std::size_t b) const { return zones_[b]; }
+    std::size_t memoryBytes() const { return zones_.capacity() * sizeof(Zone); }
+
+    // false only if no row of block b can satisfy lo <= v <= hi
+    bool mayMatch(std::size_t b, T lo, T hi) const {
+        const Zone& z = zones_[b];
+        return z.valueCount != 0 && z.min <= hi && lo <= z.max;
+    }
+
+    // true only if every row of block b satisfies lo <= v <= hi
+    bool allMatch(std::size_t b, T lo, T hi) const {
+        const Zone& z = zones_[b];
+        if (z.valueCount != z.rows) return false;   // null or NaN rows
+        return lo <= z.min && z.max <= hi;
+    }
+
+    // Blocks a [lo, hi] filter would still have to look at
+    std::size_t candidateBlocks(T lo, T hi) const {
+        std::size_t n = 0;
+        for (std::size_t b = 0; b < zones_.size(); ++b) n += mayMatch(b, lo, hi);
+        return n;
+    }
+
+private:
+    template <typename U = T>
+    static typename std::enable_if<std::is_floating_point<U>::value, bool>::type isNaN(U x) { return std::isnan(x); }
+    template <typename U = T>
+    static typename std::enable_if<!std::is_floating_point<U>::value, bool>::type isNaN(U) { return false; }
+
+    std::vector<Zone> zones_;
+};
@@ -1,6 +1,14 @@
 #include "ServiceRequest.h"
 #include "queries.h"
-
+#include "Snapshot.h"
+#include "GroupBy.h"
+#include "Streaming.h"
+#include "../common/ThreadPool.h"
+#include "../common/MemStats.h"
+#include "../common/Benchmark.h"
+#include "../common/ScalingSweep.h"
+
+#include <algorithm>
 #include <iostream>
 #include <chrono>
 #include <string>
@@ -11,129 +19,66 @@
 #include <iomanip>
 #include <omp.h>
 
-// Detect if type has .size()
-template <typename T>
-class has_size {
-private:
-    template <typename U>
-    static auto test(int) -> decltype(std::declval<const U&>().size(), std::true_type{});
-    template <typename>
-    static std::false_type test(...);
-public:
-    static constexpr bool value = decltype(test<T>(0))::value;
-};
-
-// Detect if type supports operator[](size_t) (vector-like)
-template <typename T>
-class has_index {
-private:
-    template <typename U>
-    static auto test(int) -> decltype(std::declval<const U&>()[std::size_t{}], std::true_type{});
-    template <typename>
-    static std::false_type test(...);
-public:
-    static constexpr bool value = decltype(test<T>(0))::value;
-};
-
-// Prevent compiler from optimizing away results (important for tiny queries)
-template <typename T>
-inline void doNotOptimize(const T& value) {
-#if defined(__clang__) || defined(__GNUC__)
-    asm volatile("" : : "g"(value) : "memory");
-#else
-    volatile const T* p = &value;
-    (void)p;
-#endif
-}
-
-// Print summary for sized results
-template <typename ResultT>
-typename std::enable_if<has_size<ResultT>::value>::type
-printSummary(const std::string& label, int runs, double total, const ResultT& first) {
-    std::cout << label
-              << " -> size=" << first.size()
-              << ", total=" << total << "s"
-              << ", avg=" << (total / runs) << "s\n";
-}
-
-// Print summary for scalar results
-template <typename ResultT>
-typename std::enable_if<!has_size<ResultT>::value>::type
-printSummary(const std::string& label, int runs, double total, const ResultT& first) {
-    std::cout << label
-              << " -> value=" << first
-              << ", total=" << total << "s"
-              << ", avg=" << (total / runs) << "s\n";
-}
-
-// Sample printer for vector-like containers (size + operator[])
-template <typename ResultT, typename PrintItemFn>
-typename std::enable_if<has_size<ResultT>::value && has_index<ResultT>::value>::type
-printSample(const ResultT& res, std::size_t sampleN, PrintItemFn printItem) {
-    if (sampleN == 0) return;
-    std::size_t n = res.size();
-    std::size_t k = (sampleN < n) ? sampleN : n;
-
-    std::cout << "  Results - (" << k << "/" << n << "):\n";
-    for (std::size_t i = 0; i < k; ++i) {
-        printItem(res[i], i);
-    }
-}
-
-// Sample printer for sized-but-not-indexable containers: no-op by default
-template <typename ResultT, typename PrintItemFn>
-typename std::enable_if<has_size<ResultT>::value && !has_index<ResultT>::value>::type
-printSample(const ResultT&, std::size_t, PrintItemFn) {}
-
-// Sample printer for scalars: no-op
-template <typename ResultT, typename PrintItemFn>
-typename std::enable_if<!has_size<ResultT>::value>::type
-printSample(const ResultT&, std::size_t, PrintItemFn) {}
-
-// Generic benchmark with sampling
-template <typename Fn, typename PrintItemFn>
-auto benchmark(const std::string& label,
-               int runs,
-               Fn fn,
-               std::size_t sampleN,
-               PrintItemFn printItem) -> decltype(fn()) {
-    using namespace std::chrono;
-
-    // 1) Untimed run: correctness + sample printing
-    auto first = fn();
-    printSample(first, sampleN, printItem);
-
-    // 2) Timed runs: no printing
-    auto start = high_resolution_clock::now();
-    for (int i = 0; i < runs; ++i) {
-        auto r = fn();
-        doNotOptimize(r);
-    }
-    auto end = high_resolution_clock::now();
-
-    double total = duration<double>(end - start).count();
-    printSummary(label, runs, total, first);
-
-    return first;
-}
+static constexpr int kNeighborhoodBoxes = 200;
 
-// Overload: no sample printing
-template <typename Fn>
-auto benchmark(const std::string& label, int runs, Fn fn) -> decltype(fn()) {
-    return benchmark(label, runs, fn, 0, [](const auto&, std::size_t){});
-}
+// Columns read by Queries 1-7, their indexes and the printed samples
+static const ColumnSet kQueryColumns = {Column::uniqueKey, Column::createdDate, Column::boroughUpper,
+                                        Column::complaintType, Column::latitude, Column::longitude};
 
 int main(int argc, char* argv[]) {
     std::string filename =
-        (argc > 1) ? argv[1]
-                   : "/Users/aravindreddy/Downloads/SJSU ClassWork/275 EAD/Mini1_Datasets/311_combined.csv.";
+        "/Users/aravindreddy/Downloads/SJSU ClassWork/275 EAD/Mini1_Datasets/311_combined.csv.";
+    IngestMode ingest = IngestMode::Pipelined;
+    std::string snapshotPath;
+    const std::size_t maxRecords = 14000000;
+
+    // Usage: ./main [csv_file] [--stream | --mmap] [--snapshot path] [--sweep] [--budget-mb N]
+    //               [--columns a,b,...]
+    bool sweep = false;
+    ColumnSet columns = ColumnSet::all();
+    bool projected = false;
+    std::size_t budgetMB = 0;
+    bool haveFile = false;
+    for (int a = 1; a < argc; ++a) {
+        std::string arg = argv[a];
+        if (arg == "--stream") ingest = IngestMode::Stream;
+        else if (arg == "--mmap") ingest = IngestMode::Mapped;
+        else if (arg == "--snapshot" && a + 1 < argc) snapshotPath = argv[++a];
+        else if (arg == "--sweep") sweep = true;
+        else if (arg == "--budget-mb" && a + 1 < argc) budgetMB = std::strtoull(argv[++a], nullptr, 10);
+        else if (arg == "--columns" && a + 1 < argc) {
+            if (!ColumnSet::parse(argv[++a], columns)) return 1;
+            projected = true;
+        }
+        else if (!haveFile) { filename = arg; haveFile = true; }
+    }
 
     using clock = std::chrono::high_resolution_clock;
 
+    // Streaming mode: the whole file in batches within the budget, no
+    // record cap and no full load
+    if (budgetMB > 0) {
+        std::cout << std::fixed << std::setprecision(6);
+        StreamQueryParams params;
+        params.startKey = parseDateKey("01/01/2013 12:00:00 AM");
+        params.endKey   = parseDateKey("12/31/2013 11:59:59 PM");
+        params.borough  = "BROOKLYN";
+        params.keyword  = "rodent";
+        params.minLat = 40.5;   params.maxLat = 40.9;
+        params.minLon = -74.25; params.maxLon = -73.7;
+        return runStreamingQueries(filename, budgetMB * 1024 * 1024, params, 5) ? 0 : 1;
+    }
+
     ServiceRequestOoA data;
 
+    // Reuse a snapshot built from this exact CSV if there is one; otherwise
+    // parse the CSV and (re)write the snapshot for the next run
+    const MemStats memBefore = readMemStats();
     auto loadStart = clock::now();
-    bool ok = loadServiceRequestOoA(filename, data);
+    const SnapshotSource source = snapshotSourceOf(filename, maxRecords);
+    bool fromSnapshot = !snapshotPath.empty() &&
+                        loadSnapshotOoA(snapshotPath, data, &source, projected ? &columns : nullptr);
+    bool ok = fromSnapshot || loadServiceRequestOoA(filename, data, maxRecords, ingest, columns);
     auto loadEnd = clock::now();
 
     double loadSeconds = std::chrono::duration<double>(loadEnd - loadStart).count();
@@ -145,27 +90,142 @@ int main(int argc, char* argv[]) {
 
     std::cout << std::fixed << std::setprecision(6);
 
-    std::cout << "[LOAD] file=\"" << filename << "\"\n"
+    std::cout << "[LOAD] file=\"" << (fromSnapshot ? snapshotPath : filename) << "\""
+              << " mode=" << (fromSnapshot ? "snapshot"
+                              : ingest == IngestMode::Pipelined ? "pipelined"
+                              : ingest == IngestMode::Mapped ? "mmap" : "stream") << "\n"
               << "       records=" << data.uniqueKey.size()
               << ", time=" << loadSeconds << "s\n";
+    if (projected)
+        std::cout << "       columns=" << data.loaded.names() << " (" << data.loaded.count() << " of "
+                  << static_cast<unsigned>(Column::count) << "; the rest load on first use)\n";
+
+    // Process memory around the load, and what each column holds
+    const MemStats memAfter = readMemStats();
+    printMemStats("[MEMORY] before load", memBefore);
+    printMemStats("[MEMORY] after load ", memAfter);
+    {
+        std::vector<ColumnMemory> columns = columnMemoryOoA(data);
+        std::size_t total = 0;
+        for (const auto& c : columns) total += c.bytes;
+        std::sort(columns.begin(), columns.end(),
+                  [](const ColumnMemory& a, const ColumnMemory& b) { return a.bytes > b.bytes; });
+        const double mb = 1024.0 * 1024.0;
+        const double rows = data.uniqueKey.empty() ? 1.0 : double(data.uniqueKey.size());
+        std::cout << "[COLUMNS] " << columns.size() << " columns, " << total / mb << " MB ("
+                  << total / rows << " bytes/row); largest:\n";
+        for (std::size_t i = 0; i < columns.size() && i < 8; ++i)
+            std::cout << "       " << std::left << std::setw(24) << columns[i].name << std::right
+                      << columns[i].bytes / mb << " MB (" << columns[i].bytes / rows << " bytes/row)\n";
+    }
 
-    std::cout << "Using threads (OpenMP): "
+    // A snapshot holds every column, so a projected load does not write one
+    if (!snapshotPath.empty() && !fromSnapshot && !projected) {
+        auto saveStart = clock::now();
+        bool saved = saveSnapshotOoA(data, snapshotPath, source);
+        double saveSeconds = std::chrono::duration<double>(clock::now() - saveStart).count();
+        if (saved)
+            std::cout << "[SNAPSHOT] wrote \"" << snapshotPath << "\" in " << saveSeconds << "s\n";
+    }
+
+    // Loading still uses OpenMP; the queries run on the shared pool, which is
+    // started here so its thread start-up stays out of the timings
+    std::cout << "Using threads (OpenMP load): "
               << omp_get_max_threads()
+              << ", query pool: " << ThreadPool::global().size()
+              << " workers, morsel=" << ThreadPool::kMorselRows << " rows"
               << "\n";
+    setBenchmarkContext("optimized", ThreadPool::global().size());
+
+    // Reads the columns a section needs that a projected load left out
+    const auto need = [&](ColumnSet cols) {
+        const ColumnSet missing = cols - data.loaded;
+        if (missing.empty()) return true;
+        auto start = clock::now();
+        if (!ensureColumns(data, cols)) return false;
+        std::cout << "[LAZY] loaded " << missing.names() << " from \"" << data.origin.path << "\" in "
+                  << std::chrono::duration<double>(clock::now() - start).count() << "s\n";
+        return true;
+    };
+    if (!need(kQueryColumns)) return 1;
+
+    // Substring index over complaintType, built once per load
+    auto indexStart = clock::now();
+    TextIndex complaintIndex;
+    complaintIndex.build(data.complaintType);
+    double indexSeconds = std::chrono::duration<double>(clock::now() - indexStart).count();
+    std::cout << "[INDEX] complaintType: " << data.complaintType.dictionary().size() << " values, "
+              << complaintIndex.gramCount() << " trigrams, "
+              << complaintIndex.memoryBytes() / (1024.0 * 1024.0) << " MB, time=" << indexSeconds << "s\n";
+
+    // createdDate permutation index, built once per load
+    auto sortStart = clock::now();
+    SortedIndex createdIndex;
+    createdIndex.build(data.createdDate.values());
+    double sortSeconds = std::chrono::duration<double>(clock::now() - sortStart).count();
+    std::cout << "[INDEX] createdDate sorted: " << createdIndex.size() << " rows, "
+              << createdIndex.memoryBytes() / (1024.0 * 1024.0) << " MB, time=" << sortSeconds << "s\n";
+
+    // Spatial grid over latitude/longitude, built once per load
+    auto gridStart = clock::now();
+    SpatialGrid grid;
+    buildSpatialGrid(data, grid);
+    double gridSeconds = std::chrono::duration<double>(clock::now() - gridStart).count();
+    std::cout << "[INDEX] lat/lon grid: " << grid.cellCount() << " cells, "
+              << grid.outsideCount() << " rows off-grid, "
+              << grid.memoryBytes() / (1024.0 * 1024.0) << " MB, time=" << gridSeconds << "s\n";
+
+    // Per-block min/max/null-count for the numeric and date filters
+    auto zoneStart = clock::now();
+    ZoneMapsOoA zoneMaps;
+    buildZoneMaps(data, zoneMaps);
+    double zoneSeconds = std::chrono::duration<double>(clock::now() - zoneStart).count();
+    std::cout << "[INDEX] zone maps: " << zoneMaps.createdDate.blockCount() << " blocks of "
+              << ZoneMap<uint32_t>::kBlockRows << " rows x 5 columns, "
+              << zoneMaps.memoryBytes() << " bytes, time=" << zoneSeconds << "s\n";
 
     const int runs = 15;
     const int runsAgg = 15;         // aggregation is heavier
     const std::size_t sampleN = 5;  // print only first 5 results once
+    const int runsBoxes = 3;        // each run is kNeighborhoodBoxes queries
+
+    // Scan volume of a full pass reading `bytesPerRow` of columns per row
+    const double rows = static_cast<double>(data.uniqueKey.size());
+    const auto scan = [rows](std::size_t bytesPerRow) { return ScanVolume{rows, rows * bytesPerRow}; };
 
     // Precompute date keys once
-    uint64_t startKey = parseDateKey("01/01/2013 12:00:00 AM");
-    uint64_t endKey   = parseDateKey("12/31/2013 11:59:59 PM");
+    uint32_t startKey = parseDateKey("01/01/2013 12:00:00 AM");
+    uint32_t endKey   = parseDateKey("12/31/2013 11:59:59 PM");
+
+    // --sweep: the six queries at 1, 2, 4, ... pool workers instead of the
+    // normal run
+    if (sweep) {
+        runThreadSweep({
+            sweepQuery("date range 2013 (OoA)",
+                       [&]() { return filterByCreatedDateRangeOoA_omp(data, startKey, endKey); },
+                       scan(sizeof(uint32_t))),
+            sweepQuery("borough BROOKLYN (OoA)",
+                       [&]() { return filterByBoroughOoA_omp(data, "BROOKLYN"); }, scan(sizeof(uint8_t))),
+            sweepQuery("complaint 'rodent' (OoA)",
+                       [&]() { return searchByComplaintOoA(data, "rodent"); }, scan(sizeof(uint16_t))),
+            sweepQuery("lat/lon box (OoA)",
+                       [&]() { return filterByLatLonBoxOoA(data, 40.5, 40.9, -74.25, -73.7); },
+                       scan(2 * sizeof(double))),
+            sweepQuery("average latitude (OoA)",
+                       [&]() { return averageLatitudeOoA_omp(data); }, scan(sizeof(double))),
+            sweepQuery("borough aggregation (OoA, omp fast)",
+                       [&]() { return aggregateByBoroughOoA_omp_fast(data); },
+                       scan(sizeof(uint8_t) + sizeof(uint16_t))),
+        }, runs);
+        writeBenchmarkReports();
+        return 0;
+    }
 
     std::cout << "\nQuery Outputs \n";
 
     // Query 1: Date range
     std::cout << "\n[Query 1] Date Range - filtering requests created in year 2013.\n"
-              << "Scans createdKey[] and returns indices that fall within the date bounds.\n";
+              << "Scans the packed createdDate[] keys and returns indices within the date bounds.\n";
 
     benchmark("date range 2013 (OoA)", runs,
         [&]() { return filterByCreatedDateRangeOoA_omp(data, startKey, endKey); },
@@ -173,15 +233,39 @@ int main(int argc, char* argv[]) {
         [&](std::size_t idx, std::size_t i) {
             std::cout << "    [" << i << "] idx=" << idx
                       << " key=" << data.uniqueKey[idx]
+                      << " created=\"" << formatDateKey(data.createdDate[idx]) << "\""
                       << " borough=" << data.boroughUpper[idx]
                       << " complaint=" << data.complaintType[idx]
                       << "\n";
-        }
+        },
+        scan(sizeof(uint32_t))
     );
 
+    std::cout << "Same ranges through the sorted createdDate index (binary search, then the span).\n";
+    const uint32_t dayStart = parseDateKey("03/15/2013 12:00:00 AM");
+    const uint32_t dayEnd   = parseDateKey("03/15/2013 11:59:59 PM");
+    benchmark("date range 2013 (sorted index)", runs,
+        [&]() { return filterByCreatedDateRangeIndexed(data, createdIndex, startKey, endKey); });
+    benchmark("single day 03/15/2013 (OoA scan)", runs,
+        [&]() { return filterByCreatedDateRangeOoA_omp(data, dayStart, dayEnd); }, scan(sizeof(uint32_t)));
+    benchmark("single day 03/15/2013 (sorted index)", runs,
+        [&]() { return filterByCreatedDateRangeIndexed(data, createdIndex, dayStart, dayEnd); });
+    benchmark("single day 03/15/2013 (index span only)", runs,
+        [&]() { return createdIndex.range(data.createdDate.values(), dayStart, dayEnd).size(); });
+
+    // Zone maps only pay off when dates cluster by block (the full export is
+    // close to time-ordered); report how many blocks each range still reads
+    std::cout << "Zone maps: 2013 reads " << zoneMaps.createdDate.candidateBlocks(startKey, endKey)
+              << "/" << zoneMaps.createdDate.blockCount() << " blocks, one day reads "
+              << zoneMaps.createdDate.candidateBlocks(dayStart, dayEnd) << "/" << zoneMaps.createdDate.blockCount() << ".\n";
+    benchmark("date range 2013 (zone maps)", runs,
+        [&]() { return filterByCreatedDateRangeOoA_omp(data, startKey, endKey, &zoneMaps); }, scan(sizeof(uint32_t)));
+    benchmark("single day 03/15/2013 (zone maps)", runs,
+        [&]() { return filterByCreatedDateRangeOoA_omp(data, dayStart, dayEnd, &zoneMaps); }, scan(sizeof(uint32_t)));
+
     // Query 2: Borough filter
     std::cout << "\n[Query 2] Borough Filter - selecting all requests from BROOKLYN.\n"
-              << "Uses boroughUpper[] (precomputed) and returns matching indices.\n";
+              << "Compares boroughUpper[] dictionary codes and returns matching indices.\n";
 
     benchmark("borough BROOKLYN (OoA)", runs,
         [&]() { return filterByBoroughOoA_omp(data, "BROOKLYN"); },
@@ -191,12 +275,13 @@ int main(int argc, char* argv[]) {
                       << " key=" << data.uniqueKey[idx]
                       << " complaint=" << data.complaintType[idx]
                       << "\n";
-        }
+        },
+        scan(sizeof(uint8_t))
     );
 
     // Query 3: Complaint substring
     std::cout << "\n[Query 3] Complaint Search - substring match on complaintType for \"rodent\".\n"
-              << "Uses complaintTypeLower[] to avoid per-record lowercase conversion.\n";
+              << "Matches the complaintType dictionary once, then scans the codes.\n";
 
     benchmark("complaint 'rodent' (OoA)", runs,
         [&]() { return searchByComplaintOoA(data, "rodent"); },
@@ -207,9 +292,14 @@ int main(int argc, char* argv[]) {
                       << " complaint=" << data.complaintType[idx]
                       << " borough=" << data.boroughUpper[idx]
                       << "\n";
-        }
+        },
+        scan(sizeof(uint16_t))
     );
 
+    std::cout << "Same search through the trigram index: matching codes' posting lists only.\n";
+    benchmark("complaint 'rodent' (trigram index)", runs,
+        [&]() { return searchByComplaintIndexed(complaintIndex, "rodent"); });
+
     // Query 4: Lat/Lon box
     std::cout << "\n[Query 4] Lat/Lon Box - selecting requests within NYC bounding box.\n"
               << "Numeric filter on latitude[] and longitude[] returning indices.\n";
@@ -223,27 +313,133 @@ int main(int argc, char* argv[]) {
                       << " lat=" << data.latitude[idx]
                       << " lon=" << data.longitude[idx]
                       << "\n";
-        }
+        },
+        scan(2 * sizeof(double))
     );
+    benchmark("lat/lon box (zone maps)", runs,
+        [&]() { return filterByLatLonBoxOoA(data, 40.5, 40.9, -74.25, -73.7, &zoneMaps); },
+        scan(2 * sizeof(double)));
+
+    // Dashboard-style load: many ~1 km boxes at fixed pseudo-random spots
+    std::cout << "Neighborhood boxes: " << kNeighborhoodBoxes << " boxes of 0.01 deg, scan vs grid index.\n";
+    std::vector<SpatialGrid::Box> boxes;
+    uint32_t seed = 311;
+    for (int b = 0; b < kNeighborhoodBoxes; ++b) {
+        seed = seed * 1664525u + 1013904223u;
+        const double lat = 40.5 + 0.4 * (seed >> 8) / double(1u << 24);
+        seed = seed * 1664525u + 1013904223u;
+        const double lon = -74.25 + 0.55 * (seed >> 8) / double(1u << 24);
+        boxes.push_back({lat, lat + 0.01, lon, lon + 0.01});
+    }
+    benchmark("neighborhood boxes (OoA scan)", runsBoxes, [&]() {
+        std::size_t total = 0;
+        for (const auto& b : boxes)
+            total += filterByLatLonBoxOoA(data, b.minLat, b.maxLat, b.minLon, b.maxLon).size();
+        return total;
+    }, ScanVolume{rows * kNeighborhoodBoxes, rows * kNeighborhoodBoxes * 2 * sizeof(double)});
+    benchmark("neighborhood boxes (grid index)", runsBoxes, [&]() {
+        std::size_t total = 0;
+        for (const auto& b : boxes)
+            total += filterByLatLonBoxIndexed(data, grid, b.minLat, b.maxLat, b.minLon, b.maxLon).size();
+        return total;
+    });
 
     // Query 5: Average latitude
     std::cout << "\n[Query 5] Average Latitude - computing mean latitude over all records.\n"
-              << "OpenMP reduction (sum) over latitude[] then divides by N.\n";
+              << "Per-morsel partial sums over latitude[] on the thread pool, then divides by the\n"
+              << "non-null count (" << data.latitude.nullCount() << " null latitudes).\n";
 
     benchmark("average latitude (OoA)", runs,
-        [&]() { return averageLatitudeOoA_omp(data); }
+        [&]() { return averageLatitudeOoA_omp(data); },
+        scan(sizeof(double))
     );
 
     // Query 6: Borough aggregation
     std::cout << "\n[Query 6] Borough Aggregation - total requests + top complaint per borough.\n"
-              << "Builds thread-local buckets and merges to reduce contention.\n";
+              << "GROUP BY (borough, complaint) code pairs on the engine, folded into six buckets.\n";
 
     auto zones = benchmark("borough aggregation (OoA, omp fast)", runsAgg,
-        [&]() { return aggregateByBoroughOoA_omp_fast(data); }
+        [&]() { return aggregateByBoroughOoA_omp_fast(data); },
+        scan(sizeof(uint8_t) + sizeof(uint16_t))
     );
 
     std::cout << "\n=== Borough Totals + Top Complaint (OoA, omp fast) ===\n";
     printTopComplaintPerBorough(zones);
 
+    // Query 7: Compound filter on bitmap results
+    std::cout << "\n[Query 7] Compound Filter - BROOKLYN AND 2013 AND \"rodent\" as bitmaps.\n"
+              << "Each predicate yields one bit per row; AND is a word-wise pass over N/64 words.\n";
+
+    benchmark("compound filter (bitmap scans + AND)", runs,
+        [&]() {
+            RowBitmap bm = filterByBoroughBitmap(data, "BROOKLYN");
+            bm &= filterByCreatedDateRangeBitmap(data, startKey, endKey);
+            bm &= searchByComplaintBitmap(data, "rodent");
+            return bm.toIndices();
+        },
+        sampleN,
+        [&](std::size_t idx, std::size_t i) {
+            std::cout << "    [" << i << "] idx=" << idx
+                      << " key=" << data.uniqueKey[idx]
+                      << " created=\"" << formatDateKey(data.createdDate[idx]) << "\""
+                      << " borough=" << data.boroughUpper[idx]
+                      << " complaint=" << data.complaintType[idx]
+                      << "\n";
+        },
+        scan(sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint16_t))
+    );
+
+    const RowBitmap inBrooklyn = filterByBoroughBitmap(data, "BROOKLYN");
+    const RowBitmap in2013 = filterByCreatedDateRangeBitmap(data, startKey, endKey);
+    const RowBitmap rodent = searchByComplaintBitmap(data, "rodent");
+    benchmark("compound AND only (precomputed bitmaps)", runs,
+        [&]() { return (inBrooklyn & in2013 & rodent).count(); }
+    );
+
+    // Query 8: Ad-hoc rollups through the GROUP BY engine
+    if (!need({Column::boroughUpper, Column::status, Column::latitude, Column::incidentZip,
+               Column::createdDate, Column::complaintType, Column::agency, Column::channelType}))
+        return 1;
+    std::cout << "\n[Query 8] Ad-hoc Rollups - GROUP BY on the generic engine.\n"
+              << "Dictionary keys use dense per-worker arrays; other keys use per-worker hash tables "
+              << "merged by radix partition.\n";
+
+    GroupByResult byBoroughStatus;
+    benchmark("borough x status: count, avg(latitude) (dense)", runs,
+        [&]() {
+            groupBy({groupKey("borough", data.boroughUpper), groupKey("status", data.status)},
+                    {countRows(), aggregate(AggOp::Avg, "avg_lat", data.latitude)}, byBoroughStatus);
+            return byBoroughStatus.size();
+        },
+        scan(2 * sizeof(uint8_t) + sizeof(double))
+    );
+    printGroupBy(byBoroughStatus, sampleN);
+
+    GroupByResult byZip;
+    benchmark("zip: count, avg(latitude), max(createdDate) (hash)", runs,
+        [&]() {
+            groupBy({groupKey("zip", data.incidentZip)},
+                    {countRows(),
+                     aggregate(AggOp::Avg, "avg_lat", data.latitude),
+                     aggregate(AggOp::Max, "last_created", data.createdDate)}, byZip);
+            return byZip.size();
+        },
+        scan(2 * sizeof(uint32_t) + sizeof(double))
+    );
+    printGroupBy(byZip, sampleN);
+
+    GroupByResult byComplaintAgencyChannel;
+    benchmark("complaint x agency x channel: count (dense)", runs,
+        [&]() {
+            groupBy({groupKey("complaint", data.complaintType), groupKey("agency", data.agency),
+                     groupKey("channel", data.channelType)},
+                    {countRows()}, byComplaintAgencyChannel);
+            return byComplaintAgencyChannel.size();
+        },
+        scan(2 * sizeof(uint16_t) + sizeof(uint8_t))
+    );
+    printGroupBy(byComplaintAgencyChannel, sampleN);
+
+    writeBenchmarkReports();
     return 0;
 }
\ No newline at end of file
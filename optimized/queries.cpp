@@ -1,61 +1,115 @@
 #include "queries.h"
+#include "SelectKernels.h"
+#include "GroupBy.h"
+#include "../common/ThreadPool.h"
 
 #include <iostream>
 #include <algorithm>
 #include <array>
 #include <cctype>
-#include <cstdio>
-#include <omp.h>
+#include <limits>
 
-static uint8_t to24h(uint8_t h, bool isPM) {
-    if (!isPM) return (h == 12) ? 0 : h;
-    return (h == 12) ? 12 : static_cast<uint8_t>(h + 12);
+// Borough name -> boroughUpper code; false if it never occurs (or is "")
+static bool boroughCode(const ServiceRequestOoA& data, const std::string& boroughUpper, uint8_t& code) {
+    return data.boroughUpper.find(boroughUpper, code) && code != 0;
 }
 
-// Parse "MM/DD/YYYY HH:MM:SS AM/PM" -> packed key
-uint64_t parseDateKey(const std::string& s) {
-    if (s.empty()) return 0;
+// Per complaint code: does its (lowercased) text contain the keyword?
+// Matching the dictionary (a few hundred strings) once turns the row scan
+// into a table lookup.
+static std::vector<unsigned char> complaintMatches(const ServiceRequestOoA& data, const std::string& keyword) {
+    std::string key = keyword;
+    std::transform(key.begin(), key.end(), key.begin(),
+                   [](unsigned char c){ return std::tolower(c); });
+
+    const auto& dict = data.complaintType.dictionary();
+    std::vector<unsigned char> match(dict.size(), 0);
+    for (std::size_t c = 0; c < dict.size(); ++c) {
+        std::string lower = dict[c];
+        std::transform(lower.begin(), lower.end(), lower.begin(),
+                       [](unsigned char ch){ return std::tolower(ch); });
+        match[c] = lower.find(key) != std::string::npos;
+    }
+    return match;
+}
+
+// What a zone map says about the block starting at row `begin`
+enum class BlockScan { Skip, All, Scan };
+
+template <typename T>
+static BlockScan blockScan(const ZoneMap<T>* zm, std::size_t begin, T lo, T hi) {
+    if (!zm) return BlockScan::Scan;
+    const std::size_t b = begin / ZoneMap<T>::kBlockRows;
+    if (!zm->mayMatch(b, lo, hi)) return BlockScan::Skip;
+    return zm->allMatch(b, lo, hi) ? BlockScan::All : BlockScan::Scan;
+}
+
+// Both conditions must hold
+static BlockScan both(BlockScan a, BlockScan b) {
+    if (a == BlockScan::Skip || b == BlockScan::Skip) return BlockScan::Skip;
+    return a == BlockScan::All && b == BlockScan::All ? BlockScan::All : BlockScan::Scan;
+}
+
+static std::size_t selectAll(std::size_t begin, std::size_t end, std::size_t* out) {
+    for (std::size_t i = begin; i < end; ++i) *out++ = i;
+    return end - begin;
+}
 
-    unsigned mm=0, dd=0, yyyy=0, hh=0, mi=0, ss=0;
-    char ampm[3] = {};
-    int n = std::sscanf(s.c_str(), "%u/%u/%u %u:%u:%u %2s",
-                        &mm, &dd, &yyyy, &hh, &mi, &ss, ampm);
-    if (n < 7) return 0;
+// Null dates hold kNullDate (0) and no valid key does, so a range that
+// starts above it can never match a null: no validity check per row
+static uint32_t firstDateKey(uint32_t startKey) {
+    return std::max<uint32_t>(startKey, kNullDate + 1);
+}
 
-    uint8_t hour24 = to24h(static_cast<uint8_t>(hh), (ampm[0]=='P' || ampm[0]=='p'));
+// Coordinate of row i, NaN when null: NaN fails every comparison, so code
+// that reads coordinates through accessors (the grid) never matches a null
+static double coordinateOrNaN(const NullableColumn<double>& col, std::size_t i) {
+    return col.isValid(i) ? col[i] : std::numeric_limits<double>::quiet_NaN();
+}
 
-    return (static_cast<uint64_t>(yyyy) << 40) |
-           (static_cast<uint64_t>(mm)   << 32) |
-           (static_cast<uint64_t>(dd)   << 24) |
-           (static_cast<uint64_t>(hour24) << 16) |
-           (static_cast<uint64_t>(mi)   << 8) |
-           static_cast<uint64_t>(ss);
+void buildZoneMaps(const ServiceRequestOoA& data, ZoneMapsOoA& zones) {
+    zones.createdDate.build(data.createdDate);
+    zones.latitude.build(data.latitude);
+    zones.longitude.build(data.longitude);
+    zones.incidentZip.build(data.incidentZip);
+    zones.councilDistrict.build(data.councilDistrict);
 }
 
+// All queries run on the shared ThreadPool: 64K-row morsels with work
+// stealing; index results are stitched in row order by ThreadPool::select
+// from per-worker scratch the pool keeps between calls.
+
 // QUERY 1 — Date Range Filter
 std::vector<std::size_t> filterByCreatedDateRangeOoA_omp(
     const ServiceRequestOoA& data,
-    uint64_t startKey,
-    uint64_t endKey
+    uint32_t startKey,
+    uint32_t endKey,
+    const ZoneMapsOoA* zones
 ) {
-    const std::size_t n = data.createdKey.size();
-    std::vector<std::size_t> out;
-    if (n == 0) return out;
-
-    // Mark array to avoid concurrent push_back
-    std::vector<unsigned char> keep(n, 0);
-
-    #pragma omp parallel for schedule(static)
-    for (std::size_t i = 0; i < n; ++i) {
-        uint64_t k = data.createdKey[i];
-        if (k >= startKey && k <= endKey) keep[i] = 1;
-    }
+    // The SIMD kernel compresses matching row ids of each morsel straight
+    // into the worker's selection buffer; no per-row flag array
+    startKey = firstDateKey(startKey);
+    const uint32_t* keys = data.createdDate.data();
+    const ZoneMap<uint32_t>* zm = zones ? &zones->createdDate : nullptr;
+    return ThreadPool::global().select(data.createdDate.size(),
+        [&](std::size_t begin, std::size_t end, std::size_t* out) -> std::size_t {
+            switch (blockScan(zm, begin, startKey, endKey)) {
+                case BlockScan::Skip: return 0;
+                case BlockScan::All:  return selectAll(begin, end, out);
+                case BlockScan::Scan: break;
+            }
+            return selectInRangeU32(keys, begin, end, startKey, endKey, out);
+        });
+}
 
-    out.reserve(n / 10 + 1);
-    for (std::size_t i = 0; i < n; ++i) {
-        if (keep[i]) out.push_back(i);
-    }
-    return out;
+// QUERY 1 (indexed) — O(log n) to find the span of matching dates
+std::vector<std::size_t> filterByCreatedDateRangeIndexed(
+    const ServiceRequestOoA& data,
+    const SortedIndex& createdIndex,
+    uint32_t startKey,
+    uint32_t endKey
+) {
+    return createdIndex.rowsInRange(data.createdDate.values(), firstDateKey(startKey), endKey);
 }
 
 // QUERY 2 — Borough Filter
@@ -63,25 +117,21 @@ std::vector<std::size_t> filterByBoroughOoA_omp(
     const ServiceRequestOoA& data,
     const std::string& boroughUpper
 ) {
-    const std::size_t n = data.boroughUpper.size();
-    std::vector<std::size_t> out;
-    if (n == 0) return out;
-
-    std::vector<unsigned char> keep(n, 0);
-
-    #pragma omp parallel for schedule(static)
-    for (std::size_t i = 0; i < n; ++i) {
-        // boroughUpper already precomputed in loader
-        if (!data.boroughUpper[i].empty() && data.boroughUpper[i] == boroughUpper) {
-            keep[i] = 1;
-        }
-    }
-
-    out.reserve(n / 10 + 1);
-    for (std::size_t i = 0; i < n; ++i) {
-        if (keep[i]) out.push_back(i);
-    }
-    return out;
+    // Resolve the name to its code once; a borough that never occurs
+    // (or the empty string) matches nothing
+    uint8_t target = 0;
+    if (!boroughCode(data, boroughUpper, target)) return {};
+
+    const uint8_t* codes = data.boroughUpper.codes().data();
+    return ThreadPool::global().select(data.boroughUpper.size(),
+        [&](std::size_t begin, std::size_t end, std::size_t* out) {
+            std::size_t n = 0;
+            for (std::size_t i = begin; i < end; ++i) {
+                out[n] = i;
+                n += codes[i] == target;
+            }
+            return n;
+        });
 }
 
 // QUERY 3 — Complaint Substring Search
@@ -89,78 +139,208 @@ std::vector<std::size_t> searchByComplaintOoA(
     const ServiceRequestOoA& data,
     const std::string& keyword
 ) {
-    const int n = static_cast<int>(data.complaintTypeLower.size());
-    if (n <= 0) return {};
+    const std::vector<unsigned char> match = complaintMatches(data, keyword);
+    const uint16_t* codes = data.complaintType.codes().data();
+    return ThreadPool::global().select(data.complaintType.size(),
+        [&](std::size_t begin, std::size_t end, std::size_t* out) {
+            std::size_t n = 0;
+            for (std::size_t i = begin; i < end; ++i) {
+                out[n] = i;
+                n += match[codes[i]];
+            }
+            return n;
+        });
+}
 
-    // Determine actual OpenMP thread count used
-    const int T = omp_get_max_threads();
+// QUERY 3 (indexed) — trigram lookup over the dictionary, then the
+// matching codes' posting lists; no pass over the column
+std::vector<std::size_t> searchByComplaintIndexed(
+    const TextIndex& complaintIndex,
+    const std::string& keyword
+) {
+    return complaintIndex.search(keyword);
+}
 
-    std::vector<std::vector<std::size_t>> localResults(T);
+// QUERY 4 — Lat/Lon Bounding Box
+std::vector<std::size_t> filterByLatLonBoxOoA(
+    const ServiceRequestOoA& data,
+    double minLat,
+    double maxLat,
+    double minLon,
+    double maxLon,
+    const ZoneMapsOoA* zones
+) {
+    const double* lat = data.latitude.data();
+    const double* lon = data.longitude.data();
+    // Null coordinates hold 0.0, which a box could contain: with nulls, a
+    // row also needs both validity bits. Words with no valid row are skipped.
+    const uint64_t* latValid = data.latitude.hasNulls() ? data.latitude.validity() : nullptr;
+    const uint64_t* lonValid = data.longitude.hasNulls() ? data.longitude.validity() : nullptr;
+    return ThreadPool::global().select(data.latitude.size(),
+        [&](std::size_t begin, std::size_t end, std::size_t* out) -> std::size_t {
+            if (zones) {
+                switch (both(blockScan(&zones->latitude, begin, minLat, maxLat),
+                             blockScan(&zones->longitude, begin, minLon, maxLon))) {
+                    case BlockScan::Skip: return 0;
+                    case BlockScan::All:  return selectAll(begin, end, out);
+                    case BlockScan::Scan: break;
+                }
+            }
+            std::size_t n = 0;
+            if (!latValid && !lonValid) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    out[n] = i;
+                    n += (lat[i] >= minLat) & (lat[i] <= maxLat) & (lon[i] >= minLon) & (lon[i] <= maxLon);
+                }
+                return n;
+            }
+            for (std::size_t base = begin; base < end; base += 64) {
+                const uint64_t valid = validWord(latValid, base / 64) & validWord(lonValid, base / 64);
+                if (valid == 0) continue;
+                const std::size_t stop = std::min(end, base + 64);
+                for (std::size_t i = base; i < stop; ++i) {
+                    out[n] = i;
+                    n += (lat[i] >= minLat) & (lat[i] <= maxLat) & (lon[i] >= minLon) & (lon[i] <= maxLon) &
+                         ((valid >> (i - base)) & 1);
+                }
+            }
+            return n;
+        });
+}
 
-    std::string key = keyword;
-    std::transform(key.begin(), key.end(), key.begin(),
-                   [](unsigned char c){ return std::tolower(c); });
+// QUERY 4 (indexed) — only the grid cells under the box are visited
+std::vector<std::size_t> filterByLatLonBoxIndexed(
+    const ServiceRequestOoA& data,
+    const SpatialGrid& grid,
+    double minLat,
+    double maxLat,
+    double minLon,
+    double maxLon
+) {
+    // The grid was built without null rows; candidates from the off-grid
+    // list are checked through the same accessors
+    const NullableColumn<double>& lat = data.latitude;
+    const NullableColumn<double>& lon = data.longitude;
+    std::vector<std::size_t> out;
+    if (grid.query({minLat, maxLat, minLon, maxLon},
+                   [&](std::size_t i) { return coordinateOrNaN(lat, i); },
+                   [&](std::size_t i) { return coordinateOrNaN(lon, i); }, out))
+        return out;
+    return filterByLatLonBoxOoA(data, minLat, maxLat, minLon, maxLon);
+}
+
+void buildSpatialGrid(const ServiceRequestOoA& data, SpatialGrid& grid) {
+    // Null coordinates read as NaN, so the grid does not store those rows
+    const NullableColumn<double>& lat = data.latitude;
+    const NullableColumn<double>& lon = data.longitude;
+    grid.build(data.latitude.size(),
+               [&](std::size_t i) { return coordinateOrNaN(lat, i); },
+               [&](std::size_t i) { return coordinateOrNaN(lon, i); });
+}
 
-    #pragma omp parallel for schedule(static)
-    for (int i = 0; i < n; ++i) {
-        const std::string& comp = data.complaintTypeLower[static_cast<std::size_t>(i)];
-        if (comp.find(key) != std::string::npos) {
-            int t = omp_get_thread_num();
-            localResults[t].push_back(static_cast<std::size_t>(i));
+// Bitmap variants of Queries 1-4: same predicates, one bit per row
+RowBitmap filterByCreatedDateRangeBitmap(
+    const ServiceRequestOoA& data,
+    uint32_t startKey,
+    uint32_t endKey,
+    const ZoneMapsOoA* zones
+) {
+    const std::size_t n = data.createdDate.size();
+    RowBitmap bm(n);
+    startKey = firstDateKey(startKey);
+    const uint32_t* keys = data.createdDate.data();
+    uint64_t* words = bm.words();
+    const ZoneMap<uint32_t>* zm = zones ? &zones->createdDate : nullptr;
+
+    // Morsels are whole words (64K rows); each is filled by the SIMD mask
+    // kernel unless its zone settles it (the bitmap starts all-zero)
+    ThreadPool::global().forEachMorsel(n, [&](const ThreadPool::Morsel& m, unsigned) {
+        switch (blockScan(zm, m.begin, startKey, endKey)) {
+            case BlockScan::Skip:
+                return;
+            case BlockScan::All:
+                for (std::size_t w = m.begin / 64; w < m.end / 64; ++w) words[w] = ~uint64_t(0);
+                if (m.end % 64 != 0) words[m.end / 64] = (uint64_t(1) << (m.end % 64)) - 1;
+                return;
+            case BlockScan::Scan:
+                maskInRangeU32(keys, m.begin, m.end, startKey, endKey, words);
+                return;
         }
-    }
+    });
+    return bm;
+}
 
-    std::vector<std::size_t> out;
-    for (int t = 0; t < T; ++t)
-        out.insert(out.end(), localResults[t].begin(), localResults[t].end());
-    return out;
+RowBitmap filterByBoroughBitmap(
+    const ServiceRequestOoA& data,
+    const std::string& boroughUpper
+) {
+    uint8_t target = 0;
+    if (!boroughCode(data, boroughUpper, target)) return RowBitmap(data.boroughUpper.size());
+
+    const uint8_t* codes = data.boroughUpper.codes().data();
+    return RowBitmap::fromPredicate(data.boroughUpper.size(),
+        [=](std::size_t i) { return codes[i] == target; });
 }
 
-// QUERY 4 — Lat/Lon Bounding Box
-std::vector<std::size_t> filterByLatLonBoxOoA(
+RowBitmap searchByComplaintBitmap(
+    const ServiceRequestOoA& data,
+    const std::string& keyword
+) {
+    const std::vector<unsigned char> match = complaintMatches(data, keyword);
+    const unsigned char* m = match.data();
+    const uint16_t* codes = data.complaintType.codes().data();
+    return RowBitmap::fromPredicate(data.complaintType.size(),
+        [=](std::size_t i) { return m[codes[i]] != 0; });
+}
+
+RowBitmap searchByComplaintBitmap(
+    const TextIndex& complaintIndex,
+    const std::string& keyword
+) {
+    return complaintIndex.searchBitmap(keyword);
+}
+
+RowBitmap filterByLatLonBoxBitmap(
     const ServiceRequestOoA& data,
     double minLat,
     double maxLat,
     double minLon,
     double maxLon
 ) {
-    const int n = static_cast<int>(data.latitude.size());
-    if (n <= 0) return {};
-
-    const int T = omp_get_max_threads();
-    std::vector<std::vector<std::size_t>> localResults(T);
-
-    #pragma omp parallel for schedule(static)
-    for (int i = 0; i < n; ++i) {
-        const std::size_t idx = static_cast<std::size_t>(i);
-        double lat = data.latitude[idx];
-        double lon = data.longitude[idx];
-
-        if (lat >= minLat && lat <= maxLat &&
-            lon >= minLon && lon <= maxLon) {
-            int t = omp_get_thread_num();
-            localResults[t].push_back(idx);
-        }
-    }
-
-    std::vector<std::size_t> out;
-    for (int t = 0; t < T; ++t)
-        out.insert(out.end(), localResults[t].begin(), localResults[t].end());
-    return out;
+    const double* lat = data.latitude.data();
+    const double* lon = data.longitude.data();
+    RowBitmap bm = RowBitmap::fromPredicate(data.latitude.size(),
+        [=](std::size_t i) {
+            return (lat[i] >= minLat) & (lat[i] <= maxLat) & (lon[i] >= minLon) & (lon[i] <= maxLon);
+        });
+    // Rows with a null coordinate (stored as 0.0) never match
+    if (data.latitude.hasNulls()) bm.andWords(data.latitude.validity());
+    if (data.longitude.hasNulls()) bm.andWords(data.longitude.validity());
+    return bm;
 }
 
 // QUERY 5 — Average Latitude (Reduction)
+//   Over the non-null latitudes. Null rows hold 0.0, so the plain
+//   (vectorized) sum over every row is already the sum of the valid ones;
+//   only the divisor comes from the validity bitmap.
 double averageLatitudeOoA_omp(const ServiceRequestOoA& data) {
     const std::size_t n = data.latitude.size();
-    if (n == 0) return 0.0;
+    const std::size_t valid = n - data.latitude.nullCount();
+    if (valid == 0) return 0.0;
+
+    // One partial sum per morsel, added in morsel order: the result does not
+    // depend on which worker ran what
+    std::vector<double> partial(ThreadPool::morselCount(n), 0.0);
+    const double* lat = data.latitude.data();
+    ThreadPool::global().forEachMorsel(n, [&](const ThreadPool::Morsel& m, unsigned) {
+        double sum = 0.0;
+        for (std::size_t i = m.begin; i < m.end; ++i) sum += lat[i];
+        partial[m.index] = sum;
+    });
 
     double sum = 0.0;
-    #pragma omp parallel for reduction(+:sum) schedule(static)
-    for (std::size_t i = 0; i < n; ++i) {
-        sum += data.latitude[i];
-    }
-
-    return sum / static_cast<double>(n);
+    for (double p : partial) sum += p;
+    return sum / static_cast<double>(valid);
 }
 
 // QUERY 6 — Borough Aggregation (Fast)
@@ -170,56 +350,33 @@ aggregateByBoroughOoA_omp_fast(const ServiceRequestOoA& data) {
     std::unordered_map<std::string, ZoneStatsOoA> result;
     if (n == 0) return result;
 
-    const int T = omp_get_max_threads();
-
-    auto boroughIndex = [&](const std::string& b) -> int {
-        if (b == "BRONX") return 0;
-        if (b == "BROOKLYN") return 1;
-        if (b == "MANHATTAN") return 2;
-        if (b == "QUEENS") return 3;
-        if (b == "STATEN ISLAND") return 4;
-        return 5;
+    static const char* const kBuckets[6] = {
+        "BRONX", "BROOKLYN", "MANHATTAN", "QUEENS", "STATEN ISLAND", "(unknown)"
     };
 
-    // Thread-local: 6 buckets per thread
-    std::vector<std::array<ZoneStatsOoA, 6>> local(T);
-
-    #pragma omp parallel
-    {
-        int tid = omp_get_thread_num();
-
-        #pragma omp for schedule(static)
-        for (std::size_t i = 0; i < n; ++i) {
-            int b = boroughIndex(data.boroughUpper[i]);
-
-            local[tid][b].totalCount++;
-
-            const std::string& comp = data.complaintType[i];
-            if (!comp.empty()) {
-                local[tid][b].byComplaintType[comp]++;
-            }
-        }
-    }
-
-    // Merge buckets (single-thread)
-    std::array<ZoneStatsOoA, 6> merged;
-
-    for (int t = 0; t < T; ++t) {
-        for (int b = 0; b < 6; ++b) {
-            merged[b].totalCount += local[t][b].totalCount;
-            for (const auto& kv : local[t][b].byComplaintType) {
-                merged[b].byComplaintType[kv.first] += kv.second;
-            }
-        }
-    }
-
+    // borough code -> bucket; anything outside the five boroughs is "(unknown)"
+    const auto& boroughs = data.boroughUpper.dictionary();
+    std::vector<uint8_t> bucketOf(boroughs.size(), 5);
+    for (std::size_t c = 0; c < boroughs.size(); ++c)
+        for (uint8_t b = 0; b < 5; ++b)
+            if (boroughs[c] == kBuckets[b]) bucketOf[c] = b;
+
+    // borough x complaint counts from the GROUP BY engine (dense codes,
+    // parallel merge), folded into the six buckets
+    GroupByResult groups;
+    if (!groupBy({groupKey("borough", data.boroughUpper), groupKey("complaint", data.complaintType)},
+                 {countRows()}, groups))
+        return result;
+
+    const auto& complaints = data.complaintType.dictionary();
     result.reserve(8);
-    result["BRONX"] = std::move(merged[0]);
-    result["BROOKLYN"] = std::move(merged[1]);
-    result["MANHATTAN"] = std::move(merged[2]);
-    result["QUEENS"] = std::move(merged[3]);
-    result["STATEN ISLAND"] = std::move(merged[4]);
-    result["(unknown)"] = std::move(merged[5]);
+    for (int b = 0; b < 6; ++b) result[kBuckets[b]];
+    for (std::size_t g = 0; g < groups.size(); ++g) {
+        ZoneStatsOoA& z = result[kBuckets[bucketOf[groups.keyValue(g, 0)]]];
+        const uint64_t c = groups.keyValue(g, 1);
+        z.totalCount += groups.counts[g];
+        if (c != 0) z.byComplaintType[complaints[c]] += groups.counts[g];
+    }
 
     return result;
 }
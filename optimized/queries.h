@@ -1,12 +1,34 @@
 #pragma once
 
 #include "ServiceRequest.h"
+#include "RowBitmap.h"
+#include "TextIndex.h"
+#include "SortedIndex.h"
+#include "ZoneMap.h"
+#include "../common/SpatialGrid.h"
 #include <vector>
 #include <string>
 #include <unordered_map>
 #include <cstdint>
 
-uint64_t parseDateKey(const std::string& s);
+// Block zone maps of the numeric and date columns the filters use. Filters
+// that take a `const ZoneMapsOoA*` skip blocks that cannot match and take
+// blocks that match entirely without comparing rows; nullptr scans all.
+struct ZoneMapsOoA {
+    ZoneMap<uint32_t> createdDate;
+    ZoneMap<double>   latitude;
+    ZoneMap<double>   longitude;
+    ZoneMap<uint32_t> incidentZip;
+    ZoneMap<int16_t>  councilDistrict;
+
+    std::size_t memoryBytes() const {
+        return createdDate.memoryBytes() + latitude.memoryBytes() + longitude.memoryBytes() +
+               incidentZip.memoryBytes() + councilDistrict.memoryBytes();
+    }
+};
+
+// Columns a projected load left out get empty maps (no blocks)
+void buildZoneMaps(const ServiceRequestOoA& data, ZoneMapsOoA& zones);
 
 struct ZoneStatsOoA {
     std::size_t totalCount = 0;
@@ -14,11 +36,23 @@ struct ZoneStatsOoA {
 };
 
 // QUERY 1 — Date Range Filter (OoA + OpenMP)
-// Returns indices i where createdKey[i] in [startKey, endKey]
+// Returns indices i where createdDate[i] in [startKey, endKey] (keys from
+// parseDateKey; null dates never match a range starting after 1970)
 std::vector<std::size_t> filterByCreatedDateRangeOoA_omp(
     const ServiceRequestOoA& data,
-    uint64_t startKey,
-    uint64_t endKey
+    uint32_t startKey,
+    uint32_t endKey,
+    const ZoneMapsOoA* zones = nullptr
+);
+
+// QUERY 1 (indexed) — same rows as filterByCreatedDateRangeOoA_omp from a
+// SortedIndex built over data.createdDate: two binary searches, then only
+// the matching span is read
+std::vector<std::size_t> filterByCreatedDateRangeIndexed(
+    const ServiceRequestOoA& data,
+    const SortedIndex& createdIndex,
+    uint32_t startKey,
+    uint32_t endKey
 );
 
 // QUERY 2 — Borough Filter (OoA + OpenMP)
@@ -34,8 +68,65 @@ std::vector<std::size_t> searchByComplaintOoA(
     const std::string& keyword
 );
 
+// QUERY 3 (indexed) — same rows as searchByComplaintOoA, read from the
+// posting lists of a TextIndex built over data.complaintType
+std::vector<std::size_t> searchByComplaintIndexed(
+    const TextIndex& complaintIndex,
+    const std::string& keyword
+);
+
 // QUERY 4 — Lat/Lon Bounding Box (OoA + OpenMP)
 std::vector<std::size_t> filterByLatLonBoxOoA(
+    const ServiceRequestOoA& data,
+    double minLat,
+    double maxLat,
+    double minLon,
+    double maxLon,
+    const ZoneMapsOoA* zones = nullptr
+);
+
+// QUERY 4 (indexed) — same rows as filterByLatLonBoxOoA through a
+// SpatialGrid built over data.latitude / data.longitude; boxes covering a
+// large share of the table fall back to the scan
+std::vector<std::size_t> filterByLatLonBoxIndexed(
+    const ServiceRequestOoA& data,
+    const SpatialGrid& grid,
+    double minLat,
+    double maxLat,
+    double minLon,
+    double maxLon
+);
+
+// Builds the grid for Query 4 (indexed)
+void buildSpatialGrid(const ServiceRequestOoA& data, SpatialGrid& grid);
+
+// Bitmap variants of Queries 1-4 (OoA + OpenMP)
+// Same predicates as above, returned as one bit per row. Combine them with
+// &, |, andNot() for compound filters, e.g.
+//   filterByBoroughBitmap(d, "BROOKLYN") & searchByComplaintBitmap(d, "rodent")
+RowBitmap filterByCreatedDateRangeBitmap(
+    const ServiceRequestOoA& data,
+    uint32_t startKey,
+    uint32_t endKey,
+    const ZoneMapsOoA* zones = nullptr
+);
+
+RowBitmap filterByBoroughBitmap(
+    const ServiceRequestOoA& data,
+    const std::string& boroughUpper
+);
+
+RowBitmap searchByComplaintBitmap(
+    const ServiceRequestOoA& data,
+    const std::string& keyword
+);
+
+RowBitmap searchByComplaintBitmap(
+    const TextIndex& complaintIndex,
+    const std::string& keyword
+);
+
+RowBitmap filterByLatLonBoxBitmap(
     const ServiceRequestOoA& data,
     double minLat,
     double maxLat,
@@ -43,7 +134,8 @@ std::vector<std::size_t> filterByLatLonBoxOoA(
     double maxLon
 );
 
-// QUERY 5 — Average Latitude (OoA + OpenMP Reduction)
+// QUERY 5 — Average Latitude (OoA, per-morsel partial sums), over rows whose
+// latitude is not null; 0.0 if there are none
 double averageLatitudeOoA_omp(
     const ServiceRequestOoA& data
 );
@@ -1,38 +1,25 @@
 #include "ServiceRequest.h"
+#include "../common/DateParse.h"
 #include <cstdlib>  
 #include <cstring>
 #include <stdexcept>
 #include <cstdio>
 
 
-// Internal helper: convert 12-h hour + AM/PM to 24-h
-static uint8_t to24h(uint8_t h, bool isPM) {
-    if (!isPM)  return (h == 12) ? 0  : h;      
-    else        return (h == 12) ? 12 : h + 12; 
-}
-
-
-// DateTime::parse - Accepts strings in the format:  "MM/DD/YYYY HH:MM:SS AM", Returns an invalid DateTime for empty or malformed input.
+// DateTime::parse - Accepts "MM/DD/YYYY HH:MM:SS AM" and ISO "YYYY-MM-DDTHH:MM:SS" (2020+ export), Returns an invalid DateTime for empty or malformed input.
 DateTime DateTime::parse(const char* s, std::size_t len) {
     DateTime dt;
-    if (!s || len < 11) return dt;  
-
-    unsigned mm = 0, dd = 0, yyyy = 0;
-    unsigned hh = 0, mi = 0, ss = 0;
-    char     ampm[3] = {};
-
-    // sscanf is fast enough for our purposes here
-    int n = std::sscanf(s, "%u/%u/%u %u:%u:%u %2s",
-                        &mm, &dd, &yyyy, &hh, &mi, &ss, ampm);
-    if (n < 7) return dt;  
-
-    dt.month  = static_cast<uint8_t>(mm);
-    dt.day    = static_cast<uint8_t>(dd);
-    dt.year   = static_cast<uint16_t>(yyyy);
-    dt.minute = static_cast<uint8_t>(mi);
-    dt.second = static_cast<uint8_t>(ss);
-    dt.hour   = to24h(static_cast<uint8_t>(hh),
-                      (ampm[0] == 'P' || ampm[0] == 'p'));
+
+    // Fixed-format parser from common/DateParse (replaces sscanf on the hot path)
+    CivilTime t;
+    if (!parseTimestamp(s, len, t)) return dt;
+
+    dt.month  = t.month;
+    dt.day    = t.day;
+    dt.year   = t.year;
+    dt.hour   = t.hour;
+    dt.minute = t.minute;
+    dt.second = t.second;
     dt.valid  = true;
     return dt;
 }
@@ -1,10 +1,14 @@
 #include "ServiceRequest.h"
+#include "../common/CsvRecords.h"
+#include "../common/SpatialGrid.h"
+#include "../common/MemStats.h"
+#include "../common/Benchmark.h"
 #include <iostream>
 #include <fstream>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <chrono>
-#include <mach/mach.h>
 #include <algorithm> 
 #include <map>
 #include <cmath>
@@ -12,177 +16,26 @@
 #include <utility>
 #include <iomanip>
 
-// Detect if type has .size()
-template <typename T>
-class has_size {
-private:
-    template <typename U>
-    static auto test(int) -> decltype(std::declval<const U&>().size(), std::true_type{});
-    template <typename>
-    static std::false_type test(...);
-public:
-    static constexpr bool value = decltype(test<T>(0))::value;
-};
-
-// Detect if type supports operator[](size_t) (vector-like)
-template <typename T>
-class has_index {
-private:
-    template <typename U>
-    static auto test(int) -> decltype(std::declval<const U&>()[std::size_t{}], std::true_type{});
-    template <typename>
-    static std::false_type test(...);
-public:
-    static constexpr bool value = decltype(test<T>(0))::value;
-};
-
-// Print summary for sized results
-template <typename ResultT>
-typename std::enable_if<has_size<ResultT>::value>::type
-printSummary(const std::string& label, int runs, double total, const ResultT& first) {
-    std::cout << label
-              << " -> size=" << first.size()
-              << ", total=" << total << "s"
-              << ", avg=" << (total / runs) << "s\n";
-}
-
-// Print summary for scalar results
-template <typename ResultT>
-typename std::enable_if<!has_size<ResultT>::value>::type
-printSummary(const std::string& label, int runs, double total, const ResultT& first) {
-    std::cout << label
-              << " -> value=" << first
-              << ", total=" << total << "s"
-              << ", avg=" << (total / runs) << "s\n";
-}
-
-// Sample printer for vector-like containers (size + operator[])
-template <typename ResultT, typename PrintItemFn>
-typename std::enable_if<has_size<ResultT>::value && has_index<ResultT>::value>::type
-printSample(const ResultT& res, std::size_t sampleN, PrintItemFn printItem) {
-    if (sampleN == 0) return;
-    std::size_t n = res.size();
-    std::size_t k = (sampleN < n) ? sampleN : n;
-
-    std::cout << "  Top 5 Results - (" << k << "/" << n << "):\n";
-    for (std::size_t i = 0; i < k; ++i) {
-        printItem(res[i], i);
-    }
-}
-
-// Sample printer for sized-but-not-indexable containers (e.g., map): do nothing by default
-template <typename ResultT, typename PrintItemFn>
-typename std::enable_if<has_size<ResultT>::value && !has_index<ResultT>::value>::type
-printSample(const ResultT&, std::size_t, PrintItemFn) {
-    // no-op (map/set). You already print map summaries separately.
-}
-
-// Sample printer for scalars: no-op
-template <typename ResultT, typename PrintItemFn>
-typename std::enable_if<!has_size<ResultT>::value>::type
-printSample(const ResultT&, std::size_t, PrintItemFn) {}
-
-template <typename T>
-inline void doNotOptimize(const T& value) {
-#if defined(__clang__) || defined(__GNUC__)
-    asm volatile("" : : "g"(value) : "memory");
-#else
-    volatile const T* p = &value;
-    (void)p;
-#endif
-}
-
-// Generic benchmark with sampling
-template <typename Fn, typename PrintItemFn>
-auto benchmark(const std::string& label,
-               int runs,
-               Fn fn,
-               std::size_t sampleN,
-               PrintItemFn printItem) -> decltype(fn()) {
-    using namespace std::chrono;
-
-    // 1) Untimed run: correctness + sample
-    auto first = fn();
-    printSample(first, sampleN, printItem);
-
-    // 2) Timed runs: no printing
-    auto start = high_resolution_clock::now();
-    for (int i = 0; i < runs; ++i) {
-        auto r = fn();
-        doNotOptimize(r);
-    }
-    auto end = high_resolution_clock::now();
-
-    double total = duration<double>(end - start).count();
-    printSummary(label, runs, total, first);
-
-    return first;
-}
-
-// Overload: no sample printing
-template <typename Fn>
-auto benchmark(const std::string& label, int runs, Fn fn) -> decltype(fn()) {
-    return benchmark(label, runs, fn, 0, [](const auto&, std::size_t){});
-}
-
 // cleanString — strips surrounding double-quotes if present
-std::string cleanString(const std::string& str) {
-    std::string cleaned = str;
-    if (!cleaned.empty() && cleaned.front() == '"') cleaned.erase(0, 1);
-    if (!cleaned.empty() && cleaned.back()  == '"') cleaned.pop_back();
-    return cleaned;
+std::string_view cleanString(std::string_view str) {
+    if (!str.empty() && str.front() == '"') str.remove_prefix(1);
+    if (!str.empty() && str.back()  == '"') str.remove_suffix(1);
+    return str;
 }
 
 // parseCSVLine — splits one CSV line respecting quoted fields
+// (tokenized by the SIMD structural scanner in common/CsvRecords)
 std::vector<std::string> parseCSVLine(const std::string& line) {
+    static std::vector<std::string_view> views;
+    static std::string scratch;
+    splitCSVFields(line.data(), line.size(), views, scratch);
+
     std::vector<std::string> fields;
-    fields.reserve(44);          
-    std::string current;
-    current.reserve(64);
-    bool inQuotes = false;
-
-    for (std::size_t i = 0; i < line.size(); ++i) {
-        char c = line[i];
-
-        if (inQuotes) {
-            if (c == '"') {
-                // Doubled quote inside a quoted field → literal "
-                if (i + 1 < line.size() && line[i + 1] == '"') {
-                    current += '"';
-                    ++i;           
-                } else {
-                    inQuotes = false;
-                }
-            } else {
-                current += c;
-            }
-        } else {
-            if (c == '"') {
-                inQuotes = true;
-            } else if (c == ',') {
-                fields.push_back(cleanString(current));
-                current.clear();
-            } else if (c == '\r') {
-                // ignore Windows carriage return
-            } else {
-                current += c;
-            }
-        }
-    }
-    fields.push_back(cleanString(current));  
+    fields.reserve(views.size());
+    for (std::string_view v : views) fields.emplace_back(cleanString(v));
     return fields;
 }
 
-// rssMemMB — returns physical RAM usage in MB (macOS specific)
-static double rssMemMB() {
-    mach_task_basic_info_data_t info;
-    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
-    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
-                  reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS)
-        return 0.0;
-    return static_cast<double>(info.resident_size) / (1024.0 * 1024.0);
-}
-
 // loadData — loads CSV data into vector of ServiceRequest
 std::vector<ServiceRequest> loadData(const std::string& filename) {
     auto start = std::chrono::high_resolution_clock::now();
@@ -237,6 +90,7 @@ std::vector<ServiceRequest> loadData(const std::string& filename) {
 }
 
 static std::vector<ServiceRequest> g_records;
+static SpatialGrid g_grid;   // lat/lon index over g_records, built after loading
 
 // Query 1 - range query on createdDate
 std::vector<ServiceRequest> filterByCreatedDateRange(const DateTime& start,
@@ -285,6 +139,17 @@ std::vector<ServiceRequest> searchByComplaint(const std::string& keyword) {
 std::vector<const ServiceRequest*> filterByLatLonBox(double minLat, double maxLat,
                                                      double minLon, double maxLon) {
     std::vector<const ServiceRequest*> out;
+
+    // Small boxes: only the grid cells under the box are visited
+    std::vector<std::size_t> rows;
+    if (g_grid.query({minLat, maxLat, minLon, maxLon},
+                     [](std::size_t i) { return g_records[i].latitude; },
+                     [](std::size_t i) { return g_records[i].longitude; }, rows)) {
+        out.reserve(rows.size());
+        for (std::size_t i : rows) out.push_back(&g_records[i]);
+        return out;
+    }
+
     out.reserve(1024); // start with a small capacity to avoid repeated reallocation
     for (const auto& r : g_records) {
         if (r.latitude >= minLat && r.latitude <= maxLat &&
@@ -296,11 +161,16 @@ std::vector<const ServiceRequest*> filterByLatLonBox(double minLat, double maxLa
 }
 
 // Query 5 - compute average latitude of the loaded records - demonstrates an aggregation (reduce) operation.
+// Rows without a latitude (left at 0.0) are not averaged in; 0.0 if no row has one.
 double averageLatitude() {
-    if (g_records.empty()) return 0.0;
     double sum = 0.0;
-    for (const auto &r : g_records) sum += r.latitude;
-    return sum / g_records.size();
+    std::size_t count = 0;
+    for (const auto &r : g_records) {
+        if (r.latitude == 0.0) continue;
+        sum += r.latitude;
+        ++count;
+    }
+    return count ? sum / count : 0.0;
 }
 
 // Query 6 - Aggregation: Borough totals + top complaint (SERIAL)
@@ -357,14 +227,16 @@ void printTopZones(const MapT& zones) {
 int main() {
     const std::string filename = "/Users/aravindreddy/Downloads/SJSU ClassWork/275 EAD/Mini1_Datasets/311_combined.csv.";
 
-    double memBefore = rssMemMB();
-    std::cout << "Memory before load: " << memBefore << " MB" << std::endl;
+    const MemStats memBefore = readMemStats();
+    printMemStats("Memory before load", memBefore);
 
     g_records = loadData(filename);
 
-    double memAfter = rssMemMB();
-    std::cout << "Memory after load: " << memAfter << " MB" << std::endl;
-    std::cout << "Memory delta: " << (memAfter - memBefore) << " MB" << std::endl;
+    const MemStats memAfter = readMemStats();
+    printMemStats("Memory after load", memAfter);
+    const double mb = 1024.0 * 1024.0;
+    std::cout << "Memory delta: " << (double(memAfter.rss) - double(memBefore.rss)) / mb << " MB"
+              << " (anon " << (double(memAfter.anon) - double(memBefore.anon)) / mb << " MB)" << std::endl;
 
     if (g_records.empty()) {
         std::cerr << "No records loaded. Exiting." << std::endl;
@@ -373,11 +245,24 @@ int main() {
 
     std::cout << std::fixed << std::setprecision(6);
 
+    auto gridStart = std::chrono::high_resolution_clock::now();
+    g_grid.build(g_records.size(),
+                 [](std::size_t i) { return g_records[i].latitude; },
+                 [](std::size_t i) { return g_records[i].longitude; });
+    std::chrono::duration<double> gridTime = std::chrono::high_resolution_clock::now() - gridStart;
+    std::cout << "Lat/lon grid index built in " << gridTime.count() << " seconds" << std::endl;
+
     std::cout << "\nQuery Outputs - " << std::endl;
 
     const int runs = 20;  // number of runs 
     const std::size_t sampleN = 5;
 
+    // Every query walks the whole record array; each record read pulls in at
+    // least one 64-byte cache line, however few of its fields are used
+    const double rows = static_cast<double>(g_records.size());
+    const ScanVolume fullScan{rows, rows * 64};
+    setBenchmarkContext("single_thread", 1);
+
     std::cout << "\n[Query 1] Date Range - Filtering service requests created in calendar year 2013.\n"
           << "This query scans all records and selects those whose createdDate falls within the specified range.\n";
 
@@ -391,7 +276,8 @@ int main() {
                   << " created=" << r.createdDate.toString()   // or however you print DateTime
                   << " borough=" << r.borough
                   << "\n";
-    }
+    },
+    fullScan
 );
 
     std::cout << "\n[Query 2] Borough filter - Selecting all service requests from borough: BROOKLYN.\n"
@@ -405,7 +291,8 @@ int main() {
                   << " borough=" << r.borough
                   << " complaint=" << r.complaintType
                   << "\n";
-    }
+    },
+    fullScan
 );
 
     std::cout << "\n[Query 3] Complaint search - Searching complaintType for keyword: \"rodent\".\n"
@@ -419,7 +306,8 @@ int main() {
                   << " complaint=" << r.complaintType
                   << " borough=" << r.borough
                   << "\n";
-    }
+    },
+    fullScan
 );
 
     std::cout << "\n[Query 4] Latitude/Longitude Filtering - Filtering service requests within NYC geographic bounding box.\n"
@@ -433,14 +321,16 @@ int main() {
                   << " lat=" << r->latitude
                   << " lon=" << r->longitude
                   << "\n";
-    }
+    },
+    fullScan
 );
 
     std::cout << "\n[Query 5] Average Latitude - Computing average latitude of all loaded service requests.\n"
-          << "This demonstrates a full-dataset aggregation (reduce operation).\n";
+          << "This demonstrates a full-dataset aggregation (reduce operation).\n"
+          << "Rows without a latitude are left out of the sum and the count.\n";
 
     benchmark("average latitude", runs,
-          [](){ return averageLatitude(); });
+          [](){ return averageLatitude(); }, fullScan);
 
 
     std::cout << "\n[Query 6] Borough Aggregation - Aggregating records by borough and identifying the most frequent complaint type.\n"
@@ -448,11 +338,12 @@ int main() {
 
     auto agg = benchmark("borough aggregation total+top complaint",
                      runs,
-                     [](){ return aggregateByBorough(); });
+                     [](){ return aggregateByBorough(); }, fullScan);
 
     // Print once after benchmarking
     std::cout << "\n=== Borough Totals + Top Complaint ===\n";
     printTopZones(agg);
 
+    writeBenchmarkReports();
     return 0;
 }
\ No newline at end of file